@@ -0,0 +1,203 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CharacterHistory.h"
+
+
+static FORCEINLINE VectorRegister VectorClamp01(const VectorRegister& Vec)
+{
+	return VectorMin(VectorMax(Vec, VectorZero()), VectorOne());
+}
+
+FCharacterHistory::FCharacterHistory(int32 InHistorySize)
+	: HistorySize(FMath::Max(InHistorySize, 2))
+	, Capacity(0)
+	, Head(INDEX_NONE)
+	, NumRows(0)
+{
+	Times.SetNumZeroed(HistorySize);
+}
+
+int32 FCharacterHistory::RowIndex(int32 Age) const
+{
+	return (Head - Age + HistorySize) % HistorySize;
+}
+
+float FCharacterHistory::OldestTime() const
+{
+	return NumRows > 0 ? Times[RowIndex(NumRows - 1)] : 0;
+}
+
+float FCharacterHistory::NewestTime() const
+{
+	return NumRows > 0 ? Times[Head] : 0;
+}
+
+void FCharacterHistory::Grow()
+{
+	const int32 tNewCapacity = Capacity + 4;
+
+	//Rows are interleaved by capacity, so every row has to move over
+	FFloatArray* tColumns[3] = { &X, &Y, &Z };
+	for (int tC = 0; tC < 3; tC++)
+	{
+		FFloatArray tNew;
+		tNew.SetNumZeroed(HistorySize * tNewCapacity);
+		for (int tRow = 0; tRow < HistorySize && Capacity > 0; tRow++)
+		{
+			FMemory::Memcpy(&tNew[tRow * tNewCapacity], &(*tColumns[tC])[tRow * Capacity], Capacity * sizeof(float));
+		}
+		*tColumns[tC] = MoveTemp(tNew);
+	}
+
+	Radius.AddZeroed(4);
+	HalfHeight.AddZeroed(4);
+	for (int tI = tNewCapacity - 1; tI >= Capacity; tI--) //Reversed so the lowest slot is handed out first
+	{
+		ValidFrom.Add(MAX_flt);
+		FreeSlots.Add(tI);
+	}
+	Capacity = tNewCapacity;
+}
+
+int32 FCharacterHistory::AddCharacter(float Time)
+{
+	if (FreeSlots.Num() == 0) Grow();
+
+	const int32 tSlot = FreeSlots.Pop(false);
+	ValidFrom[tSlot] = Time;
+	return tSlot;
+}
+
+void FCharacterHistory::RemoveCharacter(int32 Slot)
+{
+	if (!ValidFrom.IsValidIndex(Slot) || ValidFrom[Slot] == MAX_flt) return;
+
+	ValidFrom[Slot] = MAX_flt; //Rewind skips it from now on
+	Radius[Slot] = 0;
+	HalfHeight[Slot] = 0;
+	FreeSlots.Add(Slot);
+}
+
+void FCharacterHistory::SetCapsule(int32 Slot, float InRadius, float InHalfHeight)
+{
+	Radius[Slot] = InRadius;
+	HalfHeight[Slot] = InHalfHeight;
+}
+
+void FCharacterHistory::BeginFrame(float Time)
+{
+	const int32 tPrevious = Head;
+	Head = (Head + 1) % HistorySize;
+	NumRows = FMath::Min(NumRows + 1, HistorySize);
+	Times[Head] = Time;
+
+	if (tPrevious != INDEX_NONE && Capacity > 0)
+	{
+		FMemory::Memcpy(&X[Head * Capacity], &X[tPrevious * Capacity], Capacity * sizeof(float));
+		FMemory::Memcpy(&Y[Head * Capacity], &Y[tPrevious * Capacity], Capacity * sizeof(float));
+		FMemory::Memcpy(&Z[Head * Capacity], &Z[tPrevious * Capacity], Capacity * sizeof(float));
+	}
+}
+
+void FCharacterHistory::Record(int32 Slot, const FVector& Location)
+{
+	const int32 tIndex = Head * Capacity + Slot;
+	X[tIndex] = Location.X;
+	Y[tIndex] = Location.Y;
+	Z[tIndex] = Location.Z;
+}
+
+int32 FCharacterHistory::Rewind(float Time, const FVector& Start, const FVector& End, float ShotRadius, int32 IgnoreSlot) const
+{
+	if (NumRows == 0 || Capacity == 0) return INDEX_NONE;
+
+	//Find the rows either side of Time, walking back from the newest as most rewinds are short
+	Time = FMath::Clamp(Time, OldestTime(), NewestTime());
+	int32 tAge = 0;
+	while (tAge < NumRows - 1 && Times[RowIndex(tAge + 1)] > Time) tAge++;
+	const int32 tNewer = RowIndex(tAge);
+	const int32 tOlder = RowIndex(FMath::Min(tAge + 1, NumRows - 1));
+	const float tSpan = Times[tNewer] - Times[tOlder];
+	const VectorRegister tAlpha = VectorSetFloat1(tSpan > SMALL_NUMBER ? (Time - Times[tOlder]) / tSpan : 1.0f);
+
+	//Closest approach between the shot and each capsule's axis, segment vs segment as in Ericson's Real-Time Collision Detection
+	//The axis is always vertical, which drops most of the per lane dot products
+	const FVector tDir = End - Start;
+	const float tDirSizeSq = tDir.SizeSquared();
+	const VectorRegister tStartX = VectorSetFloat1(Start.X);
+	const VectorRegister tStartY = VectorSetFloat1(Start.Y);
+	const VectorRegister tStartZ = VectorSetFloat1(Start.Z);
+	const VectorRegister tDirX = VectorSetFloat1(tDir.X);
+	const VectorRegister tDirY = VectorSetFloat1(tDir.Y);
+	const VectorRegister tDirZ = VectorSetFloat1(tDir.Z);
+	const VectorRegister tA = VectorSetFloat1(tDirSizeSq);
+	const VectorRegister tInvA = VectorSetFloat1(tDirSizeSq > SMALL_NUMBER ? 1.0f / tDirSizeSq : 0.0f); //Zero length shot is tested as a point
+	const VectorRegister tShotRadius = VectorSetFloat1(ShotRadius);
+	const VectorRegister tParallel = VectorSetFloat1(1e-6f); //Relative to a*e
+	const VectorRegister tTiny = VectorSetFloat1(SMALL_NUMBER);
+
+	int32	tBestSlot = INDEX_NONE;
+	float	tBestS = MAX_flt;
+	for (int32 tBase = 0; tBase < Capacity; tBase += 4)
+	{
+		//Lerp 4 characters between the two rows
+		const int32 tOld = tOlder * Capacity + tBase;
+		const int32 tNew = tNewer * Capacity + tBase;
+		const VectorRegister tOldX = VectorLoadAligned(&X[tOld]);
+		const VectorRegister tOldY = VectorLoadAligned(&Y[tOld]);
+		const VectorRegister tOldZ = VectorLoadAligned(&Z[tOld]);
+		const VectorRegister tCX = VectorMultiplyAdd(VectorSubtract(VectorLoadAligned(&X[tNew]), tOldX), tAlpha, tOldX);
+		const VectorRegister tCY = VectorMultiplyAdd(VectorSubtract(VectorLoadAligned(&Y[tNew]), tOldY), tAlpha, tOldY);
+		const VectorRegister tCZ = VectorMultiplyAdd(VectorSubtract(VectorLoadAligned(&Z[tNew]), tOldZ), tAlpha, tOldZ);
+
+		const VectorRegister tRadius = VectorLoadAligned(&Radius[tBase]);
+		const VectorRegister tHalfAxis = VectorMax(VectorSubtract(VectorLoadAligned(&HalfHeight[tBase]), tRadius), VectorZero());
+		const VectorRegister tAxis = VectorAdd(tHalfAxis, tHalfAxis); //Length of the axis, which runs straight up from its bottom
+
+		//r = Start - bottom of the axis
+		const VectorRegister tRX = VectorSubtract(tStartX, tCX);
+		const VectorRegister tRY = VectorSubtract(tStartY, tCY);
+		const VectorRegister tRZ = VectorAdd(VectorSubtract(tStartZ, tCZ), tHalfAxis);
+
+		const VectorRegister tB = VectorMultiply(tDirZ, tAxis); //d1.d2
+		const VectorRegister tC = VectorMultiplyAdd(tDirX, tRX, VectorMultiplyAdd(tDirY, tRY, VectorMultiply(tDirZ, tRZ))); //d1.r
+		const VectorRegister tE = VectorMultiply(tAxis, tAxis); //d2.d2
+		const VectorRegister tF = VectorMultiply(tAxis, tRZ); //d2.r
+		const VectorRegister tAE = VectorMultiply(tA, tE);
+		const VectorRegister tDenom = VectorSubtract(tAE, VectorMultiply(tB, tB));
+
+		//s on the shot from the infinite lines, 0 if parallel. Then t on the axis from s, then s again from the clamped t
+		VectorRegister tS = VectorClamp01(VectorMultiply(VectorSubtract(VectorMultiply(tB, tF), VectorMultiply(tC, tE)), VectorReciprocalAccurate(VectorMax(tDenom, tTiny))));
+		tS = VectorSelect(VectorCompareGT(tDenom, VectorMultiply(tAE, tParallel)), tS, VectorZero());
+		const VectorRegister tT = VectorClamp01(VectorMultiply(VectorMultiplyAdd(tB, tS, tF), VectorReciprocalAccurate(VectorMax(tE, tTiny))));
+		tS = VectorClamp01(VectorMultiply(VectorSubtract(VectorMultiply(tB, tT), tC), tInvA));
+
+		//Distance between the closest points, r + d1*s - d2*t
+		const VectorRegister tDX = VectorMultiplyAdd(tDirX, tS, tRX);
+		const VectorRegister tDY = VectorMultiplyAdd(tDirY, tS, tRY);
+		const VectorRegister tDZ = VectorSubtract(VectorMultiplyAdd(tDirZ, tS, tRZ), VectorMultiply(tAxis, tT));
+		const VectorRegister tDistSq = VectorMultiplyAdd(tDX, tDX, VectorMultiplyAdd(tDY, tDY, VectorMultiply(tDZ, tDZ)));
+		const VectorRegister tReach = VectorAdd(tRadius, tShotRadius);
+
+		const int32 tHits = VectorMaskBits(VectorCompareGE(VectorMultiply(tReach, tReach), tDistSq));
+		if (tHits == 0) continue;
+
+		//Order hits by roughly where the shot enters them, closest approach less the penetration depth along the shot
+		float tLaneS[4];
+		float tLaneDepth[4];
+		VectorStore(tS, tLaneS);
+		VectorStore(VectorMultiply(VectorSubtract(VectorMultiply(tReach, tReach), tDistSq), tInvA), tLaneDepth);
+		for (int32 tLane = 0; tLane < 4; tLane++)
+		{
+			const int32 tSlot = tBase + tLane;
+			if ((tHits & (1 << tLane)) == 0 || tSlot == IgnoreSlot || ValidFrom[tSlot] >= Times[tOlder]) continue; //Free, or not recorded yet in both rows
+			const float tEntryS = tLaneS[tLane] - FMath::Sqrt(FMath::Max(tLaneDepth[tLane], 0.0f));
+			if (tEntryS < tBestS)
+			{
+				tBestS = tEntryS;
+				tBestSlot = tSlot;
+			}
+		}
+	}
+	return tBestSlot;
+}
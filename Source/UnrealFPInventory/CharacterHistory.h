@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+//Server side record of where every character was over the last HistorySize frames, used to rewind hit checks
+//Stored SoA, one row per recorded frame holding every character's location, so a rewind tests 4 capsules per SIMD op
+class UNREALFPINVENTORY_API FCharacterHistory
+{
+public:
+	FCharacterHistory(int32 InHistorySize = 64);
+
+	int32	AddCharacter(float Time); //Returns the slot to record into, history before Time is ignored for it
+	void	RemoveCharacter(int32 Slot);
+	void	SetCapsule(int32 Slot, float Radius, float HalfHeight); //Capsules are upright, so this and a location is all we need
+
+	void	BeginFrame(float Time); //Start a new row, overwriting the oldest. Carries locations forward so unrecorded slots hold still
+	void	Record(int32 Slot, const FVector& Location);
+
+	//Test the segment Start->End swept by ShotRadius against every capsule as it was at Time
+	//Returns the slot the segment enters first (approximate if capsules overlap) or INDEX_NONE, Time is clamped to the recorded window
+	int32	Rewind(float Time, const FVector& Start, const FVector& End, float ShotRadius, int32 IgnoreSlot) const;
+
+	int32	NumFrames() const { return NumRows; }
+	float	OldestTime() const;
+	float	NewestTime() const;
+
+private:
+
+	typedef TArray<float, TAlignedHeapAllocator<16>> FFloatArray; //Aligned so every row can be loaded 4 lanes at a time
+
+	int32	RowIndex(int32 Age) const; //0 is the newest row
+	void	Grow(); //Add another 4 slots to every row
+
+	int32	HistorySize; //Rows in the ring
+	int32	Capacity; //Slots per row, always a multiple of 4
+	int32	Head; //Newest row
+	int32	NumRows; //Rows recorded so far, up to HistorySize
+
+	TArray<float> Times; //Time of each row
+	FFloatArray X; //HistorySize rows of Capacity locations
+	FFloatArray Y;
+	FFloatArray Z;
+
+	FFloatArray Radius; //Per slot
+	FFloatArray HalfHeight;
+	TArray<float> ValidFrom; //Time each slot was added, MAX_flt when free
+	TArray<int32> FreeSlots;
+};
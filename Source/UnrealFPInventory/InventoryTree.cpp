@@ -0,0 +1,197 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "InventoryTree.h"
+
+#include "PickupActor.h"
+
+
+FInventoryTree::FInventoryTree()
+{
+	FNode tRoot;
+	tRoot.Id = RootId;
+	tRoot.ParentId = INDEX_NONE;
+	tRoot.SubtreeSize = 1;
+	tRoot.Weight = 0;
+	tRoot.SubtreeWeight = 0;
+	tRoot.IsContainer = true;
+	tRoot.ItemKey = nullptr;
+	Nodes.Add(tRoot);
+	IdToIndex.Add(0);
+}
+
+void FInventoryTree::AdjustAncestors(int32 Id, int32 DeltaSize, float DeltaWeight)
+{
+	while (Id != INDEX_NONE)
+	{
+		FNode& tNode = Nodes[IdToIndex[Id]];
+		tNode.SubtreeSize += DeltaSize;
+		tNode.SubtreeWeight += DeltaWeight;
+		Id = tNode.ParentId;
+	}
+}
+
+void FInventoryTree::Reindex(int32 FromIndex)
+{
+	for (int32 tI = FromIndex; tI < Nodes.Num(); tI++)
+	{
+		IdToIndex[Nodes[tI].Id] = tI;
+	}
+}
+
+int32 FInventoryTree::Add(int32 ParentId, APickupActor* Item, float Weight, bool IsContainer)
+{
+	if (!IsValidId(ParentId) || !Nodes[IdToIndex[ParentId]].IsContainer) return INDEX_NONE;
+
+	int32 tId;
+	if (FreeIds.Num() > 0) tId = FreeIds.Pop(false);
+	else tId = IdToIndex.Add(INDEX_NONE);
+
+	FNode tNode;
+	tNode.Id = tId;
+	tNode.ParentId = ParentId;
+	tNode.SubtreeSize = 1;
+	tNode.Weight = Weight;
+	tNode.SubtreeWeight = Weight;
+	tNode.IsContainer = IsContainer;
+	tNode.Item = Item;
+	tNode.ItemKey = Item;
+
+	//Goes at the end of the parent's range, only nodes after that move
+	const FNode& tParent = Nodes[IdToIndex[ParentId]];
+	const int32 tIndex = IdToIndex[ParentId] + tParent.SubtreeSize;
+	Nodes.Insert(tNode, tIndex);
+	Reindex(tIndex);
+	AdjustAncestors(ParentId, 1, Weight);
+
+	if (Item != nullptr) ItemToId.Add(Item, tId);
+	return	tId;
+}
+
+void FInventoryTree::Remove(int32 Id)
+{
+	if (!IsValidId(Id) || Id == RootId) return;
+
+	const int32 tIndex = IdToIndex[Id];
+	const int32 tSize = Nodes[tIndex].SubtreeSize;
+	AdjustAncestors(Nodes[tIndex].ParentId, -tSize, -Nodes[tIndex].SubtreeWeight);
+
+	for (int32 tI = tIndex; tI < tIndex + tSize; tI++) //Free every id in the range
+	{
+		if (Nodes[tI].ItemKey != nullptr) ItemToId.Remove(Nodes[tI].ItemKey);
+		IdToIndex[Nodes[tI].Id] = INDEX_NONE;
+		FreeIds.Add(Nodes[tI].Id);
+	}
+	Nodes.RemoveAt(tIndex, tSize, false);
+	Reindex(tIndex);
+}
+
+bool FInventoryTree::Move(int32 Id, int32 NewParentId)
+{
+	if (!IsValidId(Id) || !IsValidId(NewParentId) || Id == RootId) return false;
+	if (!Nodes[IdToIndex[NewParentId]].IsContainer || NewParentId == Id || IsInside(NewParentId, Id)) return false; //Can't put a bag inside itself
+	if (Nodes[IdToIndex[Id]].ParentId == NewParentId) return true; //Already there
+
+	//Lift the range out, it's contiguous so this is one copy and one shift
+	const int32 tIndex = IdToIndex[Id];
+	const int32 tSize = Nodes[tIndex].SubtreeSize;
+	const float tWeight = Nodes[tIndex].SubtreeWeight;
+	TArray<FNode> tSubtree(Nodes.GetData() + tIndex, tSize);
+	AdjustAncestors(Nodes[tIndex].ParentId, -tSize, -tWeight);
+	Nodes.RemoveAt(tIndex, tSize, false);
+	Reindex(tIndex);
+
+	//Drop it in at the end of the new parent's range
+	const int32 tParentIndex = IdToIndex[NewParentId];
+	const int32 tNewIndex = tParentIndex + Nodes[tParentIndex].SubtreeSize;
+	tSubtree[0].ParentId = NewParentId;
+	Nodes.Insert(tSubtree, tNewIndex);
+	Reindex(FMath::Min(tIndex, tNewIndex));
+	AdjustAncestors(NewParentId, tSize, tWeight);
+	return	true;
+}
+
+void FInventoryTree::SetWeight(int32 Id, float Weight)
+{
+	if (!IsValidId(Id)) return;
+
+	FNode& tNode = Nodes[IdToIndex[Id]];
+	const float tDelta = Weight - tNode.Weight;
+	tNode.Weight = Weight;
+	AdjustAncestors(Id, 0, tDelta);
+}
+
+int32 FInventoryTree::Find(const APickupActor* Item) const
+{
+	const int32* tId = ItemToId.Find(Item);
+	return tId != nullptr ? *tId : INDEX_NONE;
+}
+
+APickupActor* FInventoryTree::GetItem(int32 Id) const
+{
+	return IsValidId(Id) ? Nodes[IdToIndex[Id]].Item.Get() : nullptr;
+}
+
+int32 FInventoryTree::GetParent(int32 Id) const
+{
+	return IsValidId(Id) ? Nodes[IdToIndex[Id]].ParentId : INDEX_NONE;
+}
+
+int32 FInventoryTree::GetDepth(int32 Id) const
+{
+	int32 tDepth = -1;
+	while (IsValidId(Id))
+	{
+		tDepth++;
+		Id = Nodes[IdToIndex[Id]].ParentId;
+	}
+	return	tDepth;
+}
+
+bool FInventoryTree::IsInside(int32 Id, int32 ContainerId) const
+{
+	if (!IsValidId(Id) || !IsValidId(ContainerId) || Id == ContainerId) return false;
+
+	const int32 tContainerIndex = IdToIndex[ContainerId];
+	const int32 tIndex = IdToIndex[Id];
+	return tIndex > tContainerIndex && tIndex < tContainerIndex + Nodes[tContainerIndex].SubtreeSize;
+}
+
+bool FInventoryTree::IsContainer(int32 Id) const
+{
+	return IsValidId(Id) && Nodes[IdToIndex[Id]].IsContainer;
+}
+
+int32 FInventoryTree::GetCount(int32 Id) const
+{
+	return IsValidId(Id) ? Nodes[IdToIndex[Id]].SubtreeSize - 1 : 0;
+}
+
+float FInventoryTree::GetWeight(int32 Id) const
+{
+	return IsValidId(Id) ? Nodes[IdToIndex[Id]].SubtreeWeight : 0;
+}
+
+void FInventoryTree::GetChildren(int32 Id, TArray<int32>& OutIds) const
+{
+	if (!IsValidId(Id)) return;
+
+	//Hop over each child's own contents to get to the next child
+	const int32 tIndex = IdToIndex[Id];
+	const int32 tEnd = tIndex + Nodes[tIndex].SubtreeSize;
+	for (int32 tI = tIndex + 1; tI < tEnd; tI += Nodes[tI].SubtreeSize)
+	{
+		OutIds.Add(Nodes[tI].Id);
+	}
+}
+
+void FInventoryTree::GetItemsInside(int32 Id, TArray<APickupActor*>& OutItems) const
+{
+	if (!IsValidId(Id)) return;
+
+	const int32 tIndex = IdToIndex[Id];
+	for (int32 tI = tIndex + 1; tI < tIndex + Nodes[tIndex].SubtreeSize; tI++)
+	{
+		APickupActor* tItem = Nodes[tI].Item.Get();
+		if (tItem != nullptr) OutItems.Add(tItem);
+	}
+}
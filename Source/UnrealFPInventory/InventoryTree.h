@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class APickupActor; //Forward Reference
+
+//Nested inventory (bags inside bags) kept in one flat array in depth first order
+//Every node's contents follow it contiguously, so a whole container is the range [Index, Index + SubtreeSize)
+//Nodes are referred to by Id, which stays the same when nodes move about in the array
+class UNREALFPINVENTORY_API FInventoryTree
+{
+public:
+	FInventoryTree();
+
+	static const int32 RootId = 0; //The character itself, always present, always a container
+
+	int32	Add(int32 ParentId, APickupActor* Item, float Weight, bool IsContainer); //Returns new Id, or INDEX_NONE if ParentId can't hold items
+	void	Remove(int32 Id); //Removes the node and everything inside it
+	bool	Move(int32 Id, int32 NewParentId); //Move a node and its contents into another container
+	void	SetWeight(int32 Id, float Weight);
+
+	int32	Find(const APickupActor* Item) const; //INDEX_NONE if not in the inventory
+	APickupActor* GetItem(int32 Id) const;
+	int32	GetParent(int32 Id) const; //O(1)
+	int32	GetDepth(int32 Id) const; //O(depth)
+	bool	IsInside(int32 Id, int32 ContainerId) const; //O(1), true if anywhere below ContainerId
+	bool	IsContainer(int32 Id) const;
+	int32	GetCount(int32 Id) const; //Items inside, all levels, cached
+	float	GetWeight(int32 Id) const; //Own weight plus everything inside, cached
+	void	GetChildren(int32 Id, TArray<int32>& OutIds) const; //Direct contents only
+	void	GetItemsInside(int32 Id, TArray<APickupActor*>& OutItems) const; //Contents at every level, one linear pass
+	bool	IsValidId(int32 Id) const { return IdToIndex.IsValidIndex(Id) && IdToIndex[Id] != INDEX_NONE; }
+
+private:
+
+	struct FNode
+	{
+		int32	Id;
+		int32	ParentId; //Id rather than index, so moving a range doesn't need the children fixing up
+		int32	SubtreeSize; //Including itself
+		float	Weight; //Own weight
+		float	SubtreeWeight; //Weight plus everything inside
+		bool	IsContainer;
+		TWeakObjectPtr<APickupActor> Item; //Weak, the tree doesn't keep items alive
+		const APickupActor* ItemKey; //For removing from ItemToId even once Item has gone stale
+	};
+
+	void	AdjustAncestors(int32 Id, int32 DeltaSize, float DeltaWeight); //Walk up from Id, O(depth)
+	void	Reindex(int32 FromIndex); //Fix IdToIndex for every node from FromIndex on
+
+	TArray<FNode> Nodes; //Depth first order
+	TArray<int32> IdToIndex; //INDEX_NONE for free ids
+	TArray<int32> FreeIds;
+	TMap<const APickupActor*, int32> ItemToId; //Key only, never dereferenced
+};
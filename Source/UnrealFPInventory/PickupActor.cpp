@@ -1,6 +1,8 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "PickupActor.h"
+#include "PickupManager.h"
+#include "PickupBehavior.h"
 
 #include "Runtime/Engine/Classes/Components/StaticMeshComponent.h" //Needed for UStaticMeshComponent
 #include "Runtime/Engine/Classes/Engine/EngineTypes.h" //Needed for ECollisionResponse::ECR_Overlap
@@ -18,8 +20,9 @@
 // Sets default values
 APickupActor::APickupActor()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+ 	// Per frame update is done in bulk by APickupManager, we only tick ourselves if a BP uses Event Tick
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 
 	PickupRoot = CreateDefaultSubobject<USceneComponent>(TEXT("PickupRoot")); //Root for PickupMesh, used as its got a transform
 	PickupRoot->SetMobility(EComponentMobility::Movable); //Make sure its movable, or when it disappears shadow will stay
@@ -34,6 +37,16 @@ APickupActor::APickupActor()
 	OnPlayerDepiction->SetMobility(EComponentMobility::Movable); //Make sure its movable, or when it disappears shadow will stay
 
 	IsPickedUp = false;
+	Weight = 0;
+	IsContainer = false;
+	RespawnTime = 0; //Default is stay picked up
+	ManagerIndex = INDEX_NONE;
+	TickEventIndex = INDEX_NONE;
+	BehaviorAmount = 0;
+	NativeBehavior = nullptr;
+	ScriptPickedup = true; //Assume overridden until BeginPlay() has checked, that's always correct just slower
+	ScriptPickupTick = true;
+	ScriptDescription = true;
 }
 
 // Called when the game starts or when spawned
@@ -41,12 +54,69 @@ void APickupActor::BeginPlay()
 {
 	Super::BeginPlay();
 	TimeAlive = 0; //Reset time alive
+	SpawnTransform = GetActorTransform(); //Remember for respawn
 
 	WorldDepiction->SetHiddenInGame(false, true);
 
 	OnPlayerDepiction->SetHiddenInGame(true, true);
 
 	OnActorBeginOverlap.AddDynamic(this, &APickupActor::OnOverlap); //Link Overlap action handler to our code
+
+	SetActorTickEnabled(GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(APickupActor, ReceiveTick))); //Keep BP Event Tick working
+
+	//Only go through the script VM for events this class actually overrides
+	ScriptPickedup = GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(APickupActor, OnPickedup));
+	ScriptPickupTick = GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(APickupActor, OnPickupTick));
+	ScriptDescription = GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(APickupActor, GetDescription));
+	SetBehavior(Behavior);
+
+	APickupManager* tManager = APickupManager::Get(GetWorld());
+	if (tManager != nullptr) tManager->RegisterPickup(this); //TimeAlive and OnPickupTick now come from the manager
+}
+
+void APickupActor::SetBehavior(FName NewBehavior)
+{
+	Behavior = NewBehavior;
+	NativeBehavior = Behavior.IsNone() ? nullptr : FPickupBehaviorRegistry::Find(Behavior);
+	if (!Behavior.IsNone() && NativeBehavior == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s has unknown pickup behavior %s"), *GetName(), *Behavior.ToString());
+	}
+
+	APickupManager* tManager = APickupManager::Get(GetWorld(), false); //Not registered yet if called before BeginPlay()
+	if (tManager != nullptr) tManager->RefreshTickEvent(this); //Whether we need the tick event may have changed
+}
+
+void APickupActor::DispatchPickedup(AUnrealFPInventoryCharacter* OwningActor)
+{
+	if (ScriptPickedup) OnPickedup(OwningActor);
+	else if (NativeBehavior != nullptr) NativeBehavior->OnPickedup(this, OwningActor);
+}
+
+void APickupActor::DispatchPickupTick(float DeltaTime)
+{
+	if (ScriptPickupTick) OnPickupTick(DeltaTime, TimeAlive); //Send time alive to Blueprint
+	else if (NativeBehavior != nullptr) NativeBehavior->OnPickupTick(this, DeltaTime, TimeAlive);
+}
+
+FString APickupActor::DescribeItem()
+{
+	return ScriptDescription ? GetDescription() : GetDescription_Implementation();
+}
+
+bool APickupActor::NeedsTickEvent() const
+{
+	return ScriptPickupTick || (NativeBehavior != nullptr && NativeBehavior->bNeedsTick);
+}
+
+void APickupActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	APickupManager* tManager = APickupManager::Get(GetWorld(), false); //Don't spawn one while the world is tearing down
+	if (tManager != nullptr) tManager->UnregisterPickup(this);
+
+	if (EndPlayReason == EEndPlayReason::Destroyed || EndPlayReason == EEndPlayReason::RemovedFromWorld) LeaveInventory(); //Don't leave a stale entry in whoever was holding us
+
+	Super::EndPlay(EndPlayReason);
 }
 
 float APickupActor::TimeAliveGetter()
@@ -68,30 +138,86 @@ void APickupActor::OnOverlap(AActor * MyActor, AActor * OtherActor)
 		if (tInventoryActor != nullptr) //Check its the player
 		{
 			if (GEngine != nullptr) GEngine->AddOnScreenDebugMessage(-1, 1.5, FColor::White, FString::Printf(TEXT("OnOverlap() with %s"), *OtherActor->GetName()));
-			IsPickedUp = tInventoryActor->OnPickup(this); //Ask Character to pickup, they can refuse by returning false
-			if (IsPickedUp)
-			{
-				tMyPickup->SetActorEnableCollision(false); //Stop actor colliding from now on, or own bullets will bounce back
-				WorldDepiction->SetHiddenInGame(true, true);
-				OnPlayerDepiction->SetHiddenInGame(false, true);
-				OnPlayerDepiction->ResetRelativeTransform();
-			}
+			tInventoryActor->TryPickup(this); //Ask Character to pickup, they can refuse, FinishPickup() is called for us if they don't
 		}
 	}
 }
 
-// Called every frame
-void APickupActor::Tick(float DeltaTime)
+void APickupActor::FinishPickup()
 {
-	Super::Tick(DeltaTime);
+	IsPickedUp = true;
+	SetActorEnableCollision(false); //Stop actor colliding from now on, or own bullets will bounce back
+	WorldDepiction->SetHiddenInGame(true, true);
+	if (RespawnTime > 0)
+	{
+		Consume(); //Respawning pickups are used up straight away, OnPickedup has already had its chance
+	}
+	else
+	{
+		OnPlayerDepiction->SetHiddenInGame(false, true);
+		OnPlayerDepiction->ResetRelativeTransform();
+	}
+}
+
+void APickupActor::LeaveInventory()
+{
+	AActor* tHolder = GetAttachParentActor(); //Character, or a container if we're in a bag
+	while (tHolder != nullptr && !tHolder->IsA<AUnrealFPInventoryCharacter>()) tHolder = tHolder->GetAttachParentActor();
+	AUnrealFPInventoryCharacter* tOwner = Cast<AUnrealFPInventoryCharacter>(tHolder);
+	if (tOwner == nullptr) return; //Not held by anyone
+
+	tOwner->RemoveFromInventory(this); //Give the slot back
+	DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	SetActorTransform(SpawnTransform);
+}
+
+void APickupActor::Consume()
+{
+	LeaveInventory();
+	if (RespawnTime <= 0) //Doesn't come back, so nothing more to keep
+	{
+		Destroy();
+		return;
+	}
+
+	SetActorEnableCollision(false);
+	WorldDepiction->SetHiddenInGame(true, true);
+	OnPlayerDepiction->SetHiddenInGame(true, true);
+	IsPickedUp = true; //Stays picked up until the respawn comes round
+
+	APickupManager* tManager = APickupManager::Get(GetWorld());
+	if (tManager != nullptr) tManager->ScheduleRespawn(this, RespawnTime);
+}
+
+void APickupActor::Respawn()
+{
+	APickupManager* tManager = APickupManager::Get(GetWorld());
+	if (tManager != nullptr) tManager->CancelRespawn(this); //In case we were called early from BP
+
+	LeaveInventory();
+	SetActorTransform(SpawnTransform); //LeaveInventory() only does this if someone was holding us
+	TimeAlive = 0; //Reset time alive
+	ReturnToWorld();
+}
 
-	TimeAlive += DeltaTime; //Total Time Alive
-	OnPickupTick(DeltaTime, TimeAlive); //Send time alive to Blueprint
+void APickupActor::Drop(const FVector& Location)
+{
+	DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	SetActorTransform(FTransform(SpawnTransform.GetRotation(), Location, SpawnTransform.GetScale3D())); //Upright as placed, not at whatever angle the bag had
+	ReturnToWorld();
 }
 
+void APickupActor::ReturnToWorld()
+{
+	IsPickedUp = false;
+	OnPlayerDepiction->SetHiddenInGame(true, true);
+	WorldDepiction->SetHiddenInGame(false, true);
+	SetActorEnableCollision(true);
+}
 
 //Default Name Getter
 FString APickupActor::GetDescription_Implementation()
 {
+	if (NativeBehavior != nullptr) return NativeBehavior->GetDescription(this);
 	return	FString::Printf(TEXT("%s"),*GetName());
 }
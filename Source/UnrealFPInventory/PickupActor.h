@@ -5,8 +5,10 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "TimingWheel.h"
 #include "PickupActor.generated.h"
 
+struct FPickupBehavior; //Forward Reference
 
 UCLASS()
 class UNREALFPINVENTORY_API APickupActor : public AActor
@@ -21,9 +23,8 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	// Called when the actor is removed from the world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 
 public: //Set up up default components
@@ -56,12 +57,66 @@ public: //Set up up default components
 	UPROPERTY(BlueprintGetter = IsPickedUpGetter, Category = Pickup) //Link to Getter
 	bool	IsPickedUp; //Flag to show if we are picked up
 
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Pickup)
+	float	Weight; //Counted towards the weight of whatever holds us
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Pickup)
+	bool	IsContainer; //Bags and boxes, other pickups can be put inside
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Pickup)
+	float	RespawnTime; //Seconds before coming back after being picked up, 0 means stay in the inventory and never respawn
+
+	void	FinishPickup(); //Pickup side of being picked up, AUnrealFPInventoryCharacter calls this once it has taken us
+
+	UFUNCTION(BlueprintCallable, Category = Gameplay)
+	void	Consume(); //Leave the inventory, then respawn after RespawnTime or destroy if it doesn't respawn
+
+	UFUNCTION(BlueprintCallable, Category = Gameplay)
+	void	Respawn(); //Put this actor back where it started, ready to be picked up again
+
+	void	Drop(const FVector& Location); //Detach and put back in the world at Location, ready to be picked up again
+
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable)
 	FString GetDescription(); //Can override this in BP
 	FString GetDescription_Implementation(); //C++ Parent
 
+	//Native behavior, used instead of the Blueprint events unless this class overrides them in BP
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Pickup)
+	FName	Behavior; //Name registered with FPickupBehaviorRegistry, None for Blueprint only
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Pickup)
+	float	BehaviorAmount; //Parameter for the native behavior, e.g. rounds of ammo
+
+	UFUNCTION(BlueprintCallable, Category = Pickup)
+	void	SetBehavior(FName NewBehavior); //Swap native behavior at runtime
+
+	//Call these from C++ rather than the events, they skip the script VM when there is no BP override
+	void	DispatchPickedup(AUnrealFPInventoryCharacter* OwningActor);
+	void	DispatchPickupTick(float DeltaTime);
+	FString	DescribeItem();
+	bool	NeedsTickEvent() const; //True if either BP or the native behavior wants OnPickupTick
+
 private:
 
+	friend class APickupManager; //Manager does the per frame update for us
+
+	int32	ManagerIndex; //Our slot in the manager, INDEX_NONE if not registered
+	int32	TickEventIndex; //Our slot in the manager's tick event list, INDEX_NONE if nothing wants OnPickupTick
+
+	const FPickupBehavior* NativeBehavior; //Resolved from Behavior in BeginPlay()
+
+	uint8	ScriptPickedup : 1; //Which events this class overrides in BP, cached in BeginPlay()
+	uint8	ScriptPickupTick : 1;
+	uint8	ScriptDescription : 1;
+
+	FTimingWheelHandle RespawnHandle; //Pending respawn in the manager, if any
+
+	FTransform	SpawnTransform; //Where we go back to on respawn
+
+	void	LeaveInventory(); //Detach from whoever is holding us and go back to SpawnTransform
+
+	void	ReturnToWorld(); //Visible, collidable and not picked up, wherever we are now
+
 	UFUNCTION()	//As we are dynamically adding this we need it to be a UFUNCTION()
 	void OnOverlap(AActor * MyActor, AActor * OtherActor);
 
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PickupBehavior.h"
+
+#include "PickupActor.h"
+#include "UnrealFPInventoryCharacter.h"
+
+
+FString FPickupBehaviorDefaults::GetDescription(const APickupActor* Pickup)
+{
+	return	FString::Printf(TEXT("%s"), *Pickup->GetName()); //Same as APickupActor's default
+}
+
+TArray<TPair<const TCHAR*, const FPickupBehavior*>>& FPickupBehaviorRegistry::Pending()
+{
+	static TArray<TPair<const TCHAR*, const FPickupBehavior*>> Pending;
+	return Pending;
+}
+
+TMap<FName, const FPickupBehavior*>& FPickupBehaviorRegistry::Behaviors()
+{
+	static TMap<FName, const FPickupBehavior*> Behaviors;
+	return Behaviors;
+}
+
+void FPickupBehaviorRegistry::Register(const TCHAR* Name, const FPickupBehavior& Behavior)
+{
+	Pending().Add(TPair<const TCHAR*, const FPickupBehavior*>(Name, &Behavior));
+}
+
+const FPickupBehavior* FPickupBehaviorRegistry::Find(FName Name)
+{
+	check(IsInGameThread());
+
+	if (Pending().Num() > 0) //First lookup, by now FName is safe to use
+	{
+		for (int tI = 0; tI < Pending().Num(); tI++)
+		{
+			Behaviors().Add(FName(Pending()[tI].Key), Pending()[tI].Value);
+		}
+		Pending().Empty();
+	}
+
+	const FPickupBehavior* const* tFound = Behaviors().Find(Name);
+	return tFound != nullptr ? *tFound : nullptr;
+}
+
+
+//Built in behaviors
+
+//Adds BehaviorAmount rounds when picked up
+struct FAmmoPickupBehavior : FPickupBehaviorDefaults
+{
+	static void OnPickedup(APickupActor* Pickup, AUnrealFPInventoryCharacter* OwningActor)
+	{
+		if (OwningActor != nullptr) OwningActor->UpdateAmmo(FMath::RoundToInt(Pickup->BehaviorAmount));
+	}
+
+	static FString GetDescription(const APickupActor* Pickup)
+	{
+		return	FString::Printf(TEXT("Ammo x%d"), FMath::RoundToInt(Pickup->BehaviorAmount));
+	}
+};
+IMPLEMENT_PICKUP_BEHAVIOR(FAmmoPickupBehavior, "Ammo")
+
+//Spins the world depiction at BehaviorAmount degrees a second until picked up
+struct FSpinPickupBehavior : FPickupBehaviorDefaults
+{
+	enum { bNeedsTick = true };
+
+	static void OnPickupTick(APickupActor* Pickup, float DeltaTime, float TimeAlive)
+	{
+		if (!Pickup->IsPickedUp) Pickup->WorldDepiction->AddLocalRotation(FRotator(0.f, Pickup->BehaviorAmount * DeltaTime, 0.f));
+	}
+};
+IMPLEMENT_PICKUP_BEHAVIOR(FSpinPickupBehavior, "Spin")
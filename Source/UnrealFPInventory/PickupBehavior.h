@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class APickupActor; //Forward Reference
+class AUnrealFPInventoryCharacter;
+
+//Function table for a native pickup behavior, every entry is always set so callers never need to check
+struct FPickupBehavior
+{
+	void	(*OnPickedup)(APickupActor* Pickup, AUnrealFPInventoryCharacter* OwningActor);
+	void	(*OnPickupTick)(APickupActor* Pickup, float DeltaTime, float TimeAlive);
+	FString	(*GetDescription)(const APickupActor* Pickup);
+	bool	bNeedsTick; //False lets the manager skip the tick dispatch completely
+};
+
+//Derive behaviors from this and hide whichever of these they implement
+struct UNREALFPINVENTORY_API FPickupBehaviorDefaults
+{
+	enum { bNeedsTick = false };
+
+	static void		OnPickedup(APickupActor* Pickup, AUnrealFPInventoryCharacter* OwningActor) {}
+	static void		OnPickupTick(APickupActor* Pickup, float DeltaTime, float TimeAlive) {}
+	static FString	GetDescription(const APickupActor* Pickup);
+};
+
+//One table per behavior type, the calls are bound at compile time
+template<typename BehaviorType>
+const FPickupBehavior& MakePickupBehavior()
+{
+	static const FPickupBehavior Behavior = { &BehaviorType::OnPickedup, &BehaviorType::OnPickupTick, &BehaviorType::GetDescription, BehaviorType::bNeedsTick != 0 };
+	return Behavior;
+}
+
+//Name to behavior lookup, items pick theirs with APickupActor::Behavior
+class UNREALFPINVENTORY_API FPickupBehaviorRegistry
+{
+public:
+	static void		Register(const TCHAR* Name, const FPickupBehavior& Behavior); //Safe to call during static init
+	static const FPickupBehavior* Find(FName Name); //nullptr if not registered
+
+private:
+	static TArray<TPair<const TCHAR*, const FPickupBehavior*>>& Pending(); //Registered but not yet in the map, FName may not be usable during static init
+	static TMap<FName, const FPickupBehavior*>& Behaviors();
+};
+
+struct FPickupBehaviorRegistrar
+{
+	FPickupBehaviorRegistrar(const TCHAR* Name, const FPickupBehavior& Behavior) { FPickupBehaviorRegistry::Register(Name, Behavior); }
+};
+
+#define IMPLEMENT_PICKUP_BEHAVIOR(BehaviorType, Name) \
+	static FPickupBehaviorRegistrar GPickupBehaviorRegistrar_##BehaviorType(TEXT(Name), MakePickupBehavior<BehaviorType>());
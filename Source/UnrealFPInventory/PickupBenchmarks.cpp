@@ -0,0 +1,288 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+//Console commands for measuring pickup costs in a running game, results go to the log
+
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+#include "UObject/UObjectGlobals.h"
+#include "Kismet/GameplayStatics.h"
+#include "Async/TaskGraphInterfaces.h"
+
+#include "PickupActor.h"
+#include "PickupBehavior.h"
+#include "PickupManager.h"
+#include "UnrealFPInventoryCharacter.h"
+#include "UnrealFPInventoryProjectile.h"
+
+
+//Time Iterations calls of Body in milliseconds
+template<typename BodyType>
+static double TimeCalls(int32 Iterations, BodyType Body)
+{
+	const double tStart = FPlatformTime::Seconds();
+	for (int32 tI = 0; tI < Iterations; tI++)
+	{
+		Body(tI);
+	}
+	return (FPlatformTime::Seconds() - tStart) * 1000.0;
+}
+
+//Benchmark pickups live out of the way and can't be touched, collision goes off before BeginPlay gets a chance to overlap anything
+static APickupActor* SpawnBenchPickup(UWorld* World, UClass* Class, const FVector& Location)
+{
+	FActorSpawnParameters tSpawnParams;
+	tSpawnParams.ObjectFlags |= RF_Transient;
+	tSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	tSpawnParams.bDeferConstruction = true;
+	const FTransform tTransform(Location);
+	APickupActor* tPickup = World->SpawnActor<APickupActor>(Class, tTransform, tSpawnParams);
+	if (tPickup == nullptr) return nullptr;
+	tPickup->SetActorEnableCollision(false);
+	tPickup->FinishSpawning(tTransform);
+	return tPickup;
+}
+
+static const FVector BenchLocation(0.f, 0.f, -100000.f); //Well below anything in the map
+
+//fp.Bench.PickupDispatch <ScriptClassPath> [Behavior] [Iterations]
+//ScriptClassPath is a BP pickup whose events implement the same logic as the native Behavior, e.g. Ammo or Spin
+//Times those BP events through the script VM against calling Behavior's function table directly
+static void BenchPickupDispatch(const TArray<FString>& Args, UWorld* World)
+{
+	if (World == nullptr) return;
+	if (Args.Num() == 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("fp.Bench.PickupDispatch: needs a BP pickup class that implements the behavior in its events"));
+		return;
+	}
+
+	UClass* tScriptClass = LoadClass<APickupActor>(nullptr, *Args[0]);
+	const FName tBehavior = Args.Num() > 1 ? FName(*Args[1]) : FName(TEXT("Spin"));
+	const int32 tIterations = Args.Num() > 2 ? FMath::Max(FCString::Atoi(*Args[2]), 1) : 100000;
+	const FPickupBehavior* tNative = FPickupBehaviorRegistry::Find(tBehavior);
+	if (tScriptClass == nullptr || tNative == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("fp.Bench.PickupDispatch: can't load pickup class %s or find behavior %s"), *Args[0], *tBehavior.ToString());
+		return;
+	}
+
+	//Same instance data both sides, the BP one keeps no native behavior so its events are the only thing doing work
+	APickupActor* tScriptPickup = SpawnBenchPickup(World, tScriptClass, BenchLocation);
+	APickupActor* tNativePickup = SpawnBenchPickup(World, APickupActor::StaticClass(), BenchLocation);
+	if (tScriptPickup == nullptr || tNativePickup == nullptr) return;
+	tScriptPickup->SetBehavior(NAME_None);
+	tNativePickup->BehaviorAmount = tScriptPickup->BehaviorAmount;
+
+	//Ammo wants someone to give rounds to, put their count back afterwards
+	AUnrealFPInventoryCharacter* tCharacter = Cast<AUnrealFPInventoryCharacter>(UGameplayStatics::GetPlayerPawn(World, 0));
+	const int tAmmo = tCharacter != nullptr ? tCharacter->Ammo : 0;
+
+	int32 tSink = 0; //Stop the description calls being optimised away
+	const double tVMPickedup = TimeCalls(tIterations, [tScriptPickup, tCharacter](int32) { tScriptPickup->OnPickedup(tCharacter); });
+	const double tVMTick = TimeCalls(tIterations, [tScriptPickup](int32) { tScriptPickup->OnPickupTick(0.016f, tScriptPickup->TimeAlive); });
+	const double tVMDescription = TimeCalls(tIterations, [tScriptPickup, &tSink](int32) { tSink += tScriptPickup->GetDescription().Len(); });
+	const double tNativePickedup = TimeCalls(tIterations, [tNative, tNativePickup, tCharacter](int32) { tNative->OnPickedup(tNativePickup, tCharacter); });
+	const double tNativeTick = TimeCalls(tIterations, [tNative, tNativePickup](int32) { tNative->OnPickupTick(tNativePickup, 0.016f, tNativePickup->TimeAlive); });
+	const double tNativeDescription = TimeCalls(tIterations, [tNative, tNativePickup, &tSink](int32) { tSink += tNative->GetDescription(tNativePickup).Len(); });
+
+	if (tCharacter != nullptr) tCharacter->Ammo = tAmmo;
+	tScriptPickup->Destroy();
+	tNativePickup->Destroy();
+
+	//An event BP doesn't implement does no work in the VM column, so flag it rather than compare it
+	const auto tInScript = [tScriptClass](FName Event) { return tScriptClass->IsFunctionImplementedInScript(Event) ? TEXT("") : TEXT("  (not implemented in BP)"); };
+	UE_LOG(LogTemp, Log, TEXT("fp.Bench.PickupDispatch %s vs native %s, %d calls each (%d)"), *tScriptClass->GetName(), *tBehavior.ToString(), tIterations, tSink);
+	UE_LOG(LogTemp, Log, TEXT("  OnPickedup      VM %8.3f ms  native %8.3f ms%s"), tVMPickedup, tNativePickedup, tInScript(GET_FUNCTION_NAME_CHECKED(APickupActor, OnPickedup)));
+	UE_LOG(LogTemp, Log, TEXT("  OnPickupTick    VM %8.3f ms  native %8.3f ms%s"), tVMTick, tNativeTick, tInScript(GET_FUNCTION_NAME_CHECKED(APickupActor, OnPickupTick)));
+	UE_LOG(LogTemp, Log, TEXT("  GetDescription  VM %8.3f ms  native %8.3f ms%s"), tVMDescription, tNativeDescription, tInScript(GET_FUNCTION_NAME_CHECKED(APickupActor, GetDescription)));
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BenchPickupDispatchCommand(
+	TEXT("fp.Bench.PickupDispatch"),
+	TEXT("fp.Bench.PickupDispatch <ScriptClassPath> [Behavior] [Iterations] - time a BP pickup's events through the script VM vs the same native behavior"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchPickupDispatch));
+
+//fp.Bench.PickupUpdate [Counts...]
+//Times the manager's native pickup update on the game thread and across the task graph with Count extra pickups spawned
+//The smallest count where parallel wins is the value for fp.Pickup.MinParallelBatch on this machine
+static void BenchPickupUpdate(const TArray<FString>& Args, UWorld* World)
+{
+	APickupManager* tManager = APickupManager::Get(World);
+	if (tManager == nullptr) return;
+
+	TArray<int32> tCounts;
+	for (int tI = 0; tI < Args.Num(); tI++)
+	{
+		tCounts.Add(FMath::Max(FCString::Atoi(*Args[tI]), 0));
+	}
+	if (tCounts.Num() == 0) tCounts = { 256, 1024, 2048, 4096, 16384, 65536 };
+
+	UE_LOG(LogTemp, Log, TEXT("fp.Bench.PickupUpdate, %d worker threads"), FTaskGraphInterface::Get().GetNumWorkerThreads());
+
+	const int32 tPasses = 200;
+	TArray<APickupActor*> tPickups;
+	for (int tC = 0; tC < tCounts.Num(); tC++)
+	{
+		const int32 tSide = FMath::Max(FMath::CeilToInt(FMath::Sqrt((float)tCounts[tC])), 1);
+		for (int32 tI = 0; tI < tCounts[tC]; tI++)
+		{
+			APickupActor* tPickup = SpawnBenchPickup(World, APickupActor::StaticClass(), BenchLocation + FVector((tI % tSide) * 100.f, (tI / tSide) * 100.f, 0.f));
+			if (tPickup != nullptr) tPickups.Add(tPickup);
+		}
+
+		//DeltaTime 0, so the pickups' TimeAlive is left as it was
+		const double tSerial = TimeCalls(tPasses, [tManager](int32) { tManager->UpdateTimeAlive(0.f, true); }) * 1000.0 / tPasses;
+		const double tParallel = TimeCalls(tPasses, [tManager](int32) { tManager->UpdateTimeAlive(0.f, false); }) * 1000.0 / tPasses;
+		UE_LOG(LogTemp, Log, TEXT("  %7d pickups  game thread %9.2f us  parallel %9.2f us"), tManager->NumPickups(), tSerial, tParallel);
+
+		for (int tI = 0; tI < tPickups.Num(); tI++)
+		{
+			tPickups[tI]->Destroy();
+		}
+		tPickups.Reset();
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BenchPickupUpdateCommand(
+	TEXT("fp.Bench.PickupUpdate"),
+	TEXT("fp.Bench.PickupUpdate [Counts...] - time the native pickup update on the game thread vs ParallelFor, to pick fp.Pickup.MinParallelBatch"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchPickupUpdate));
+
+//Time one collection in milliseconds, mark is reachability analysis and purge is freeing whatever it found unreachable
+static void TimeCollection(double& OutMark, double& OutPurge)
+{
+	double tStart = FPlatformTime::Seconds();
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, false);
+	OutMark = (FPlatformTime::Seconds() - tStart) * 1000.0;
+	tStart = FPlatformTime::Seconds();
+	IncrementalPurgeGarbage(false);
+	OutPurge = (FPlatformTime::Seconds() - tStart) * 1000.0;
+}
+
+//Time a collection that finds everything reachable, then one that frees what Release() lets go of, in milliseconds
+struct FGCTimes
+{
+	double	LiveGC; //Every collection pays this while the pickups are alive
+	double	DeadGC; //Mark once they are garbage
+	double	Purge; //Freeing them
+};
+
+template<typename ReleaseType>
+static FGCTimes TimeGC(ReleaseType Release)
+{
+	FGCTimes tTimes;
+	double tUnused;
+	TimeCollection(tTimes.LiveGC, tUnused);
+	Release();
+	TimeCollection(tTimes.DeadGC, tTimes.Purge);
+	return tTimes;
+}
+
+//fp.Bench.PickupGC [Counts...] [PickupClassPath]
+//What Count pickups cost every collection while alive, and the collection and purge that frees them
+static void BenchPickupGC(const TArray<FString>& Args, UWorld* World)
+{
+	if (World == nullptr) return;
+
+	TArray<int32> tCounts;
+	UClass* tClass = APickupActor::StaticClass();
+	for (int tI = 0; tI < Args.Num(); tI++)
+	{
+		if (Args[tI].IsNumeric()) tCounts.Add(FMath::Max(FCString::Atoi(*Args[tI]), 1));
+		else tClass = LoadClass<APickupActor>(nullptr, *Args[tI]);
+		if (tClass == nullptr)
+		{
+			UE_LOG(LogTemp, Error, TEXT("fp.Bench.PickupGC: can't load pickup class %s"), *Args[tI]);
+			return;
+		}
+	}
+	if (tCounts.Num() == 0) tCounts = { 1000, 10000, 100000 };
+
+	UE_LOG(LogTemp, Log, TEXT("fp.Bench.PickupGC %s"), *tClass->GetName());
+
+	TArray<APickupActor*> tPickups;
+	for (int tC = 0; tC < tCounts.Num(); tC++)
+	{
+		const int32 tCount = tCounts[tC];
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true); //Start from a clean heap so earlier runs don't count
+
+		tPickups.Reset(tCount);
+		const int32 tSide = FMath::CeilToInt(FMath::Sqrt((float)tCount));
+		for (int32 tI = 0; tI < tCount; tI++)
+		{
+			APickupActor* tPickup = SpawnBenchPickup(World, tClass, BenchLocation + FVector((tI % tSide) * 100.f, (tI / tSide) * 100.f, 0.f));
+			if (tPickup != nullptr) tPickups.Add(tPickup);
+		}
+
+		const FGCTimes tTimes = TimeGC([&tPickups]()
+		{
+			for (int tI = 0; tI < tPickups.Num(); tI++)
+			{
+				tPickups[tI]->Destroy();
+			}
+			tPickups.Reset();
+		});
+		UE_LOG(LogTemp, Log, TEXT("  %7d pickups  live GC %8.3f ms  destroyed GC %8.3f ms  purge %8.3f ms"), tCount, tTimes.LiveGC, tTimes.DeadGC, tTimes.Purge);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BenchPickupGCCommand(
+	TEXT("fp.Bench.PickupGC"),
+	TEXT("fp.Bench.PickupGC [Counts...] [PickupClassPath] - time garbage collection with that many pickups alive, then destroyed"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchPickupGC));
+
+//fp.Bench.ProjectileGC [Shots] [ProjectileClassPath]
+//The same shots fired by spawning and destroying a projectile each, then through one pooled projectile, timing the collection after each
+//Needs authority, so run it standalone or on the server
+static void BenchProjectileGC(const TArray<FString>& Args, UWorld* World)
+{
+	if (World == nullptr) return;
+
+	const int32 tShots = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1000;
+	UClass* tClass = Args.Num() > 1 ? LoadClass<AUnrealFPInventoryProjectile>(nullptr, *Args[1]) : AUnrealFPInventoryProjectile::StaticClass();
+	if (tClass == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("fp.Bench.ProjectileGC: can't load projectile class %s"), *Args[1]);
+		return;
+	}
+
+	FActorSpawnParameters tSpawnParams;
+	tSpawnParams.ObjectFlags |= RF_Transient;
+	tSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	const FTransform tTransform(BenchLocation);
+
+	//Spawn and destroy, every shot leaves an actor and its components for the next collection
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true); //Start from a clean heap
+	const double tSpawned = TimeCalls(tShots, [World, tClass, &tTransform, &tSpawnParams](int32)
+	{
+		AUnrealFPInventoryProjectile* tProjectile = World->SpawnActor<AUnrealFPInventoryProjectile>(tClass, tTransform, tSpawnParams);
+		if (tProjectile != nullptr) tProjectile->Release(); //Not pooled, so this destroys it
+	});
+	double tSpawnedMark, tSpawnedPurge;
+	TimeCollection(tSpawnedMark, tSpawnedPurge);
+
+	//Pooled, one projectile launched and parked for every shot
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+	AUnrealFPInventoryProjectile* tPooled = World->SpawnActor<AUnrealFPInventoryProjectile>(tClass, tTransform, tSpawnParams);
+	if (tPooled == nullptr) return;
+	tPooled->SetPooled();
+	const float tNow = World->GetTimeSeconds();
+	const double tReused = TimeCalls(tShots, [tPooled, tNow](int32)
+	{
+		tPooled->Launch(BenchLocation, FRotator::ZeroRotator, tNow);
+		tPooled->Release();
+	});
+	double tPooledMark, tPooledPurge;
+	TimeCollection(tPooledMark, tPooledPurge);
+	tPooled->Destroy();
+
+	UE_LOG(LogTemp, Log, TEXT("fp.Bench.ProjectileGC %s, %d shots"), *tClass->GetName(), tShots);
+	UE_LOG(LogTemp, Log, TEXT("  spawn/destroy  shots %8.3f ms  GC %8.3f ms  purge %8.3f ms"), tSpawned, tSpawnedMark, tSpawnedPurge);
+	UE_LOG(LogTemp, Log, TEXT("  pooled         shots %8.3f ms  GC %8.3f ms  purge %8.3f ms"), tReused, tPooledMark, tPooledPurge);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BenchProjectileGCCommand(
+	TEXT("fp.Bench.ProjectileGC"),
+	TEXT("fp.Bench.ProjectileGC [Shots] [ProjectileClassPath] - time firing and the following garbage collection, spawn/destroy vs pooled"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchProjectileGC));
@@ -0,0 +1,154 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PickupManager.h"
+
+#include "PickupActor.h"
+#include "EngineUtils.h" //Needed for TActorIterator
+#include "Async/ParallelFor.h" //Needed for ParallelFor()
+
+static TAutoConsoleVariable<int32> CVarPickupMinParallelBatch(
+	TEXT("fp.Pickup.MinParallelBatch"),
+	2048,
+	TEXT("Below this many pickups the native pickup update stays on the game thread. Use fp.Bench.PickupUpdate to find the crossover on the target machine."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarPickupRespawnResolution(
+	TEXT("fp.Pickup.RespawnResolution"),
+	0.1f,
+	TEXT("Seconds per respawn wheel tick, respawns are rounded up to this. Clamped to at least 0.001, safe to change while running."),
+	ECVF_Default);
+
+
+// Sets default values
+APickupManager::APickupManager()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
+
+	RespawnClock = 0;
+}
+
+APickupManager* APickupManager::Get(UWorld* World, bool CreateIfMissing)
+{
+	if (World == nullptr) return nullptr;
+
+	for (TActorIterator<APickupManager> tIt(World); tIt; ++tIt) //Iterates by class, so cheap even with lots of actors
+	{
+		if (!tIt->IsPendingKill()) return *tIt;
+	}
+
+	if (!CreateIfMissing) return nullptr;
+
+	FActorSpawnParameters tSpawnParams;
+	tSpawnParams.ObjectFlags |= RF_Transient; //Never save this into the level
+	return World->SpawnActor<APickupManager>(tSpawnParams);
+}
+
+void APickupManager::RegisterPickup(APickupActor* Pickup)
+{
+	if (Pickup == nullptr || Pickup->ManagerIndex != INDEX_NONE) return; //Already registered
+
+	Pickup->ManagerIndex = Pickups.Add(Pickup);
+	RefreshTickEvent(Pickup);
+}
+
+void APickupManager::RefreshTickEvent(APickupActor* Pickup)
+{
+	if (Pickup == nullptr || Pickup->ManagerIndex == INDEX_NONE) return; //Not registered
+
+	//Only queue tick dispatch for pickups that override the event in BP or have a native behavior that ticks
+	const bool tNeedsTickEvent = Pickup->NeedsTickEvent();
+	if (tNeedsTickEvent && Pickup->TickEventIndex == INDEX_NONE)
+	{
+		Pickup->TickEventIndex = TickEventPickups.Add(Pickup);
+	}
+	else if (!tNeedsTickEvent)
+	{
+		RemoveTickEvent(Pickup);
+	}
+}
+
+void APickupManager::UnregisterPickup(APickupActor* Pickup)
+{
+	if (Pickup == nullptr || Pickup->ManagerIndex == INDEX_NONE) return; //Not registered
+
+	//Swap with the last entry so removal is O(1), then fix up the index of the one we moved
+	Pickups.RemoveAtSwap(Pickup->ManagerIndex, 1, false);
+	if (Pickups.IsValidIndex(Pickup->ManagerIndex) && Pickups[Pickup->ManagerIndex] != nullptr) Pickups[Pickup->ManagerIndex]->ManagerIndex = Pickup->ManagerIndex;
+	Pickup->ManagerIndex = INDEX_NONE;
+
+	CancelRespawn(Pickup);
+	RemoveTickEvent(Pickup);
+}
+
+void APickupManager::RemoveTickEvent(APickupActor* Pickup)
+{
+	if (Pickup->TickEventIndex == INDEX_NONE) return;
+
+	TickEventPickups.RemoveAtSwap(Pickup->TickEventIndex, 1, false);
+	if (TickEventPickups.IsValidIndex(Pickup->TickEventIndex) && TickEventPickups[Pickup->TickEventIndex] != nullptr) TickEventPickups[Pickup->TickEventIndex]->TickEventIndex = Pickup->TickEventIndex;
+	Pickup->TickEventIndex = INDEX_NONE;
+}
+
+float APickupManager::GetRespawnResolution()
+{
+	return FMath::Max(CVarPickupRespawnResolution.GetValueOnGameThread(), 0.001f);
+}
+
+void APickupManager::ScheduleRespawn(APickupActor* Pickup, float Delay)
+{
+	if (Pickup == nullptr) return;
+
+	CancelRespawn(Pickup); //Only ever one respawn pending per pickup
+	const uint64 tTicks = (uint64)FMath::Max(1, FMath::CeilToInt(Delay / GetRespawnResolution()));
+	Pickup->RespawnHandle = RespawnWheel.Insert(RespawnWheel.GetCurrentTick() + tTicks, Pickup);
+}
+
+void APickupManager::CancelRespawn(APickupActor* Pickup)
+{
+	if (Pickup != nullptr) RespawnWheel.Cancel(Pickup->RespawnHandle);
+}
+
+void APickupManager::UpdateTimeAlive(float DeltaTime, bool SingleThread)
+{
+	//Each iteration only touches its own pickup so it can run on any thread
+	ParallelFor(Pickups.Num(), [this, DeltaTime](int32 tI)
+	{
+		APickupActor* tPickup = Pickups[tI];
+		if (tPickup != nullptr) tPickup->TimeAlive += DeltaTime * tPickup->CustomTimeDilation; //Total Time Alive, same dilation an actor tick would get
+	}, SingleThread);
+}
+
+// Called every frame
+void APickupManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	UpdateTimeAlive(DeltaTime, Pickups.Num() < CVarPickupMinParallelBatch.GetValueOnGameThread());
+
+	//Tick events, back on the game thread as one batch, native behaviors skip the script VM
+	TickEventBatch.Reset();
+	TickEventBatch.Append(TickEventPickups);
+	for (int tI = 0; tI < TickEventBatch.Num(); tI++)
+	{
+		APickupActor* tPickup = TickEventBatch[tI];
+		if (tPickup == nullptr || tPickup->TickEventIndex == INDEX_NONE || tPickup->IsPendingKill()) continue; //Removed by an earlier event this frame
+		tPickup->DispatchPickupTick(DeltaTime * tPickup->CustomTimeDilation);
+	}
+
+	//Respawns, everything that expired this frame comes out of the wheel in one go
+	//Only whole ticks are taken off the clock, so a new resolution applies from here on rather than rescaling the time already passed
+	RespawnClock += DeltaTime;
+	const double tResolution = GetRespawnResolution();
+	const uint64 tTicks = (uint64)FMath::FloorToDouble(RespawnClock / tResolution);
+	RespawnClock -= tTicks * tResolution;
+	RespawnWheel.Advance(RespawnWheel.GetCurrentTick() + tTicks, RespawnBatch);
+	for (int tI = 0; tI < RespawnBatch.Num(); tI++)
+	{
+		APickupActor* tPickup = RespawnBatch[tI].Get();
+		if (tPickup == nullptr || tPickup->IsPendingKill()) continue;
+		tPickup->RespawnHandle.Invalidate();
+		tPickup->Respawn();
+	}
+	RespawnBatch.Reset();
+}
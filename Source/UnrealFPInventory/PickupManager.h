@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "TimingWheel.h"
+#include "PickupManager.generated.h"
+
+class APickupActor; //Forward Reference
+
+//One per world, updates every pickup in a single tick instead of each pickup ticking itself
+//The native part runs across worker threads, only Blueprint events come back to the game thread
+UCLASS(NotPlaceable, Transient)
+class UNREALFPINVENTORY_API APickupManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	APickupManager();
+
+	static APickupManager* Get(UWorld* World, bool CreateIfMissing = true); //Find the manager for this world, spawning it if needed
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	void	RegisterPickup(APickupActor* Pickup); //Called from pickup BeginPlay()
+	void	UnregisterPickup(APickupActor* Pickup); //Called from pickup EndPlay()
+	void	RefreshTickEvent(APickupActor* Pickup); //Add to or remove from the tick event list after the pickup's behavior changes
+
+	void	UpdateTimeAlive(float DeltaTime, bool SingleThread); //Native part of Tick(), public so fp.Bench.PickupUpdate can time it both ways
+	int32	NumPickups() const { return Pickups.Num(); }
+
+	void	ScheduleRespawn(APickupActor* Pickup, float Delay); //Pickup->Respawn() gets called after Delay seconds
+	void	CancelRespawn(APickupActor* Pickup);
+
+private:
+
+	void	RemoveTickEvent(APickupActor* Pickup); //Same swap removal as Pickups
+
+	UPROPERTY()
+	TArray<APickupActor*> Pickups; //Every registered pickup, native update runs over these. GC nulls any that die without EndPlay()
+
+	UPROPERTY()
+	TArray<APickupActor*> TickEventPickups; //Subset that need OnPickupTick, from BP or a native behavior
+
+	TArray<APickupActor*> TickEventBatch; //Copy of TickEventPickups taken each frame, so BP can spawn/destroy pickups while we dispatch
+
+	TTimingWheel<TWeakObjectPtr<APickupActor>> RespawnWheel; //One wheel for every spawn point instead of a timer each
+
+	double	RespawnClock; //Seconds not yet turned into whole wheel ticks
+
+	static float GetRespawnResolution(); //fp.Pickup.RespawnResolution, clamped to at least 1ms
+
+	TArray<TWeakObjectPtr<APickupActor>> RespawnBatch; //Pickups whose respawn expired this frame
+};
@@ -0,0 +1,184 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+//Handle returned by TTimingWheel::Insert(), keep it to cancel the timer
+struct FTimingWheelHandle
+{
+	FTimingWheelHandle() : Index(INDEX_NONE), Serial(0) {}
+
+	bool	IsValid() const { return Index != INDEX_NONE; }
+	void	Invalidate() { Index = INDEX_NONE; }
+
+	int32	Index; //Node in the wheel's pool
+	uint32	Serial; //Stops a stale handle cancelling a node that has been reused
+};
+
+//Hierarchical timing wheel, O(1) insert and cancel, expired timers are collected in bulk by Advance()
+//Level 0 has one slot per tick, each slot of a higher level covers a whole turn of the level below
+//Timers in higher levels are cascaded down when the level below wraps, so per tick cost only depends on what expires
+template<typename PayloadType>
+class TTimingWheel
+{
+public:
+	enum { Level0Bits = 8, LevelNBits = 6, NumLevels = 4 };
+	enum { Level0Slots = 1 << Level0Bits, LevelNSlots = 1 << LevelNBits };
+
+	static constexpr uint64 MaxDelay = (uint64(1) << (Level0Bits + (NumLevels - 1) * LevelNBits)) - 1; //Longer delays are clamped to this
+
+	TTimingWheel()
+		: CurrentTick(0)
+		, FreeList(INDEX_NONE)
+		, NumActive(0)
+	{
+		Heads.Init(INDEX_NONE, Level0Slots + (NumLevels - 1) * LevelNSlots);
+	}
+
+	uint64	GetCurrentTick() const { return CurrentTick; }
+	int32	Num() const { return NumActive; }
+
+	//Schedule Payload to come out of Advance() once we reach ExpiryTick
+	FTimingWheelHandle Insert(uint64 ExpiryTick, const PayloadType& Payload)
+	{
+		int32 tIndex = FreeList;
+		if (tIndex != INDEX_NONE) FreeList = Nodes[tIndex].Next;
+		else tIndex = Nodes.AddDefaulted();
+
+		FNode& tNode = Nodes[tIndex];
+		tNode.Expiry = FMath::Clamp(ExpiryTick, CurrentTick + 1, CurrentTick + MaxDelay); //Can't expire in the past, or beyond the top level
+		tNode.Payload = Payload;
+		Link(tIndex);
+		NumActive++;
+
+		FTimingWheelHandle tHandle;
+		tHandle.Index = tIndex;
+		tHandle.Serial = tNode.Serial;
+		return tHandle;
+	}
+
+	//Remove a pending timer, returns false if it had already expired or been cancelled
+	bool Cancel(FTimingWheelHandle& Handle)
+	{
+		const bool tLive = Handle.IsValid() && Nodes.IsValidIndex(Handle.Index) && Nodes[Handle.Index].Serial == Handle.Serial && Nodes[Handle.Index].Bucket != INDEX_NONE;
+		if (tLive)
+		{
+			Unlink(Handle.Index);
+			Free(Handle.Index);
+		}
+		Handle.Invalidate();
+		return tLive;
+	}
+
+	//Move time forward to NewTick, appending the payload of every timer that expired on the way
+	void Advance(uint64 NewTick, TArray<PayloadType>& OutExpired)
+	{
+		if (NumActive == 0) //Nothing pending, skip straight there
+		{
+			CurrentTick = FMath::Max(CurrentTick, NewTick);
+			return;
+		}
+
+		while (CurrentTick < NewTick)
+		{
+			CurrentTick++;
+
+			const int32 tSlot = int32(CurrentTick & (Level0Slots - 1));
+			if (tSlot == 0) //Level 0 wrapped, pull the next batch down from the levels above
+			{
+				for (int32 tLevel = 1; tLevel < NumLevels; tLevel++)
+				{
+					const int32 tLevelSlot = int32((CurrentTick >> LevelShift(tLevel)) & (LevelNSlots - 1));
+					Cascade(LevelBucket(tLevel, tLevelSlot));
+					if (tLevelSlot != 0) break; //This level didn't wrap, so the ones above don't need to
+				}
+			}
+
+			int32 tIndex = Heads[tSlot];
+			Heads[tSlot] = INDEX_NONE;
+			while (tIndex != INDEX_NONE)
+			{
+				const int32 tNext = Nodes[tIndex].Next;
+				OutExpired.Add(Nodes[tIndex].Payload);
+				Free(tIndex);
+				tIndex = tNext;
+			}
+		}
+	}
+
+private:
+
+	struct FNode
+	{
+		FNode() : Prev(INDEX_NONE), Next(INDEX_NONE), Bucket(INDEX_NONE), Serial(0), Expiry(0) {}
+
+		int32	Prev; //Intrusive list within the bucket, Next doubles as the free list link
+		int32	Next;
+		int32	Bucket; //INDEX_NONE when free
+		uint32	Serial;
+		uint64	Expiry;
+		PayloadType	Payload;
+	};
+
+	static int32 LevelShift(int32 Level) { return Level0Bits + (Level - 1) * LevelNBits; } //Bits below the slot index of a level
+	static int32 LevelBucket(int32 Level, int32 Slot) { return Level0Slots + (Level - 1) * LevelNSlots + Slot; }
+
+	int32 BucketFor(uint64 Expiry) const
+	{
+		const uint64 tDelta = Expiry - CurrentTick;
+		if (tDelta < Level0Slots) return int32(Expiry & (Level0Slots - 1));
+
+		int32 tLevel = 1;
+		while (tLevel < NumLevels - 1 && tDelta >= (uint64(1) << (LevelShift(tLevel) + LevelNBits))) tLevel++;
+		return LevelBucket(tLevel, int32((Expiry >> LevelShift(tLevel)) & (LevelNSlots - 1)));
+	}
+
+	void Link(int32 Index)
+	{
+		FNode& tNode = Nodes[Index];
+		tNode.Bucket = BucketFor(tNode.Expiry);
+		tNode.Prev = INDEX_NONE;
+		tNode.Next = Heads[tNode.Bucket];
+		if (tNode.Next != INDEX_NONE) Nodes[tNode.Next].Prev = Index;
+		Heads[tNode.Bucket] = Index;
+	}
+
+	void Unlink(int32 Index)
+	{
+		FNode& tNode = Nodes[Index];
+		if (tNode.Prev != INDEX_NONE) Nodes[tNode.Prev].Next = tNode.Next;
+		else Heads[tNode.Bucket] = tNode.Next;
+		if (tNode.Next != INDEX_NONE) Nodes[tNode.Next].Prev = tNode.Prev;
+	}
+
+	void Free(int32 Index)
+	{
+		FNode& tNode = Nodes[Index];
+		tNode.Bucket = INDEX_NONE;
+		tNode.Serial++; //Any handle still pointing here is now stale
+		tNode.Payload = PayloadType();
+		tNode.Prev = INDEX_NONE;
+		tNode.Next = FreeList;
+		FreeList = Index;
+		NumActive--;
+	}
+
+	void Cascade(int32 Bucket) //Re-insert everything in a bucket, relative to the current tick they land in a lower level
+	{
+		int32 tIndex = Heads[Bucket];
+		Heads[Bucket] = INDEX_NONE;
+		while (tIndex != INDEX_NONE)
+		{
+			const int32 tNext = Nodes[tIndex].Next;
+			Link(tIndex);
+			tIndex = tNext;
+		}
+	}
+
+	uint64	CurrentTick;
+	int32	FreeList; //Head of unused nodes
+	int32	NumActive;
+	TArray<int32> Heads; //First node in each bucket, level 0 slots then each higher level
+	TArray<FNode> Nodes; //Pool, indices stay stable so handles can point into it
+};
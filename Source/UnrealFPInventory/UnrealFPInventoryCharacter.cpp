@@ -8,9 +8,11 @@
 #include "Components/InputComponent.h"
 #include "GameFramework/InputSettings.h"
 #include "Kismet/GameplayStatics.h"
+#include "GameFramework/GameStateBase.h"
 
 #include "PickupActor.h"
 #include "ActorPickupLocation.h"
+#include "UnrealFPInventoryGameMode.h"
 
 #include <EngineGlobals.h> //Needed for GEngine->AddOnScreenDebugMessage()
 #include <Runtime/Engine/Classes/Engine/Engine.h> //Needed for GEngine->AddOnScreenDebugMessage()
@@ -65,6 +67,8 @@ AUnrealFPInventoryCharacter::AUnrealFPInventoryCharacter()
 	// Default offset from the character location for projectiles to spawn
 	GunOffset = FVector(100.0f, 0.0f, 10.0f);
 	Ammo = 0; //No Ammo
+	ScriptOnPickup = true; //Assume overridden until BeginPlay() has checked
+	ScriptCanPickupBatch = true;
 }
 
 void AUnrealFPInventoryCharacter::BeginPlay()
@@ -79,11 +83,23 @@ void AUnrealFPInventoryCharacter::BeginPlay()
 
 	ShowGun(false);
 
+	ScriptOnPickup = GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(AUnrealFPInventoryCharacter, OnPickup));
+	ScriptCanPickupBatch = GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(AUnrealFPInventoryCharacter, CanPickupBatch));
 
+	AUnrealFPInventoryGameMode* tGameMode = GetWorld()->GetAuthGameMode<AUnrealFPInventoryGameMode>(); //Only on the server
+	if (tGameMode != nullptr) tGameMode->RegisterHistory(this); //Record where we are for lag compensated hits
 }
 
 void AUnrealFPInventoryCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason) //Tidy up after play by removing dynamically added Abilities
 {
+	AUnrealFPInventoryGameMode* tGameMode = GetWorld()->GetAuthGameMode<AUnrealFPInventoryGameMode>();
+	if (tGameMode != nullptr) tGameMode->UnregisterHistory(this);
+
+	for (int tI = 0; tI < ProjectilePool.Num(); tI++) //Nobody else will hand these out again
+	{
+		if (ProjectilePool[tI] != nullptr) ProjectilePool[tI]->Destroy();
+	}
+	ProjectilePool.Empty();
 
 
 	Super::EndPlay(EndPlayReason);
@@ -143,12 +159,15 @@ void AUnrealFPInventoryCharacter::OnFire()
 			// MuzzleOffset is in camera space, so transform it to world space before offsetting from the character location to find the final muzzle position
 			const FVector SpawnLocation = ((FP_MuzzleLocation != nullptr) ? FP_MuzzleLocation->GetComponentLocation() : GetActorLocation()) + SpawnRotation.RotateVector(GunOffset);
 
-			//Set Spawn Collision Handling Override
-			FActorSpawnParameters ActorSpawnParams;
-			ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
-
-			// spawn the projectile at the muzzle
-			World->SpawnActor<AUnrealFPInventoryProjectile>(ProjectileClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
+			if (HasAuthority()) // listen server or standalone, we are seeing the present
+			{
+				FireProjectile(SpawnLocation, SpawnRotation, World->GetTimeSeconds());
+			}
+			else // the server spawns it, telling it when we fired so hits can be rewound by our latency
+			{
+				const AGameStateBase* GameState = World->GetGameState();
+				ServerFire(SpawnLocation, SpawnRotation, (GameState != NULL) ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds());
+			}
 		}
 	}
 
@@ -172,6 +191,51 @@ void AUnrealFPInventoryCharacter::OnFire()
 }
 
 
+bool AUnrealFPInventoryCharacter::ServerFire_Validate(FVector_NetQuantize Location, FRotator Rotation, float FireTime)
+{
+	// muzzle has to be somewhere near us, allowing for movement correction
+	return FMath::IsFinite(FireTime) && FVector::DistSquared(Location, GetActorLocation()) < FMath::Square(1000.f);
+}
+
+void AUnrealFPInventoryCharacter::ServerFire_Implementation(FVector_NetQuantize Location, FRotator Rotation, float FireTime)
+{
+	if (Ammo <= 0 || ProjectileClass == NULL) return;
+
+	// never in the future, and no further back than the server allows
+	const AUnrealFPInventoryGameMode* GameMode = GetWorld()->GetAuthGameMode<AUnrealFPInventoryGameMode>();
+	FireProjectile(Location, Rotation, (GameMode != NULL) ? GameMode->ClampFireTime(FireTime) : GetWorld()->GetTimeSeconds());
+	Ammo--;
+}
+
+void AUnrealFPInventoryCharacter::FireProjectile(const FVector& Location, const FRotator& Rotation, float FireTime)
+{
+	UWorld* const World = GetWorld();
+	if (World == NULL || ProjectileClass == NULL) return;
+
+	// reuse a parked projectile if we have one, only spawn when the pool needs to grow
+	AUnrealFPInventoryProjectile* Projectile = nullptr;
+	for (int tI = 0; tI < ProjectilePool.Num() && Projectile == nullptr; tI++)
+	{
+		if (ProjectilePool[tI] != nullptr && !ProjectilePool[tI]->IsInFlight()) Projectile = ProjectilePool[tI];
+	}
+	if (Projectile != nullptr)
+	{
+		Projectile->Launch(Location, Rotation, FireTime);
+		return;
+	}
+
+	// spawn the projectile at the muzzle, deferred so FireTimestamp is set before BeginPlay
+	const FTransform SpawnTransform(Rotation, Location);
+	Projectile = World->SpawnActorDeferred<AUnrealFPInventoryProjectile>(ProjectileClass, SpawnTransform, this, this, ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding);
+	if (Projectile == nullptr) return;
+	Projectile->FireTimestamp = FireTime;
+	UGameplayStatics::FinishSpawningActor(Projectile, SpawnTransform);
+	if (Projectile->IsPendingKill()) return; // collided on spawn
+
+	Projectile->SetPooled();
+	ProjectilePool.Add(Projectile);
+}
+
 void AUnrealFPInventoryCharacter::MoveForward(float Value)
 {
 	if (Value != 0.0f)
@@ -208,6 +272,11 @@ void AUnrealFPInventoryCharacter::LookUpAtRate(float Rate)
 bool AUnrealFPInventoryCharacter::OnPickup_Implementation(APickupActor* tPickup)
 {
 	DebugPrint("Default OnPickup_Implementation()");
+	if (tPickup->RespawnTime > 0) //Used up straight away by FinishPickup(), so like PickupBatch() it doesn't need an attach point
+	{
+		tPickup->DispatchPickedup(this); //Signal object who picked up
+		return	true;
+	}
 	TArray<UActorPickupLocation*> tLocations;	//Where items can go on Actor
 	GetComponents(tLocations,true);
 	for (int tI=0; tI< tLocations.Num();tI++)
@@ -219,7 +288,8 @@ bool AUnrealFPInventoryCharacter::OnPickup_Implementation(APickupActor* tPickup)
 			tPickup->AttachToComponent(tLocations[tI], FAttachmentTransformRules::SnapToTargetNotIncludingScale);
 			UE_LOG(LogTemp, Log, TEXT("Attached to %d out of %d"), tI, tLocations.Num());
 			Pickups.Add(tPickup);
-			tPickup->OnPickedup(this); //Signal object who picked up
+			Inventory.Add(FInventoryTree::RootId, tPickup, tPickup->Weight, tPickup->IsContainer);
+			tPickup->DispatchPickedup(this); //Signal object who picked up
 			return	true;
 		}
 	}
@@ -227,6 +297,181 @@ bool AUnrealFPInventoryCharacter::OnPickup_Implementation(APickupActor* tPickup)
 	return	false;
 }
 
+bool AUnrealFPInventoryCharacter::TryPickup(APickupActor* Pickup)
+{
+	if (!(ScriptOnPickup ? OnPickup(Pickup) : OnPickup_Implementation(Pickup))) return false; //Refused
+
+	Pickup->FinishPickup();
+	NotifyInventoryChanged(TArray<APickupActor*>({ Pickup })); //After FinishPickup, so IsPickedUp is set and respawning items have already gone
+	return	true;
+}
+
+bool AUnrealFPInventoryCharacter::CanPickupBatch_Implementation(const TArray<APickupActor*>& Batch)
+{
+	return	true;
+}
+
+void AUnrealFPInventoryCharacter::NotifyInventoryChanged(const TArray<APickupActor*>& Added)
+{
+	TArray<APickupActor*> tHeld;
+	tHeld.Reserve(Added.Num());
+	for (int tI = 0; tI < Added.Num(); tI++)
+	{
+		if (Inventory.Find(Added[tI]) != INDEX_NONE) tHeld.Add(Added[tI]);
+	}
+	if (tHeld.Num() > 0) OnInventoryChanged(tHeld);
+}
+
+void AUnrealFPInventoryCharacter::GetFreePickupLocations(TArray<UActorPickupLocation*>& OutLocations)
+{
+	GetComponents(OutLocations, true);
+	OutLocations.RemoveAllSwap([](UActorPickupLocation* tLocation) { return tLocation->GetNumChildrenComponents() != 0; }, false);
+}
+
+bool AUnrealFPInventoryCharacter::PickupBatch(const TArray<APickupActor*>& Batch)
+{
+	if (Batch.Num() == 0) return false;
+
+	//Check everything before touching anything, so a failure leaves the inventory and the pickups as they were
+	TSet<APickupActor*> tSeen;
+	tSeen.Reserve(Batch.Num());
+	int tSlotsNeeded = 0;
+	for (int tI = 0; tI < Batch.Num(); tI++)
+	{
+		APickupActor* tPickup = Batch[tI];
+		bool tDuplicate = false;
+		tSeen.Add(tPickup, &tDuplicate);
+		if (!IsValid(tPickup) || tPickup->IsPickedUp || tDuplicate)
+		{
+			UE_LOG(LogTemp, Log, TEXT("PickupBatch() item %d can't be picked up, batch rejected"), tI);
+			return false;
+		}
+		if (tPickup->RespawnTime <= 0) tSlotsNeeded++; //Respawning pickups are consumed straight away so don't need a slot
+	}
+
+	//Reserve all the slots in one pass
+	TArray<UActorPickupLocation*> tFree;
+	GetFreePickupLocations(tFree);
+	if (tFree.Num() < tSlotsNeeded)
+	{
+		UE_LOG(LogTemp, Log, TEXT("PickupBatch() needs %d attach points, only %d free"), tSlotsNeeded, tFree.Num());
+		return false;
+	}
+
+	//BP rules for single pickups live in OnPickup, which can't be asked without it taking the item, so BP gets its say through CanPickupBatch
+	if (ScriptOnPickup && !ScriptCanPickupBatch)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("PickupBatch() %s overrides OnPickup in BP but not CanPickupBatch, OnPickup rules aren't applied to batches"), *GetClass()->GetName());
+	}
+	if (!(ScriptCanPickupBatch ? CanPickupBatch(Batch) : CanPickupBatch_Implementation(Batch)))
+	{
+		UE_LOG(LogTemp, Log, TEXT("PickupBatch() vetoed by CanPickupBatch"));
+		return false;
+	}
+
+	//Commit, nothing below can fail
+	int tSlot = 0;
+	Pickups.Reserve(Pickups.Num() + tSlotsNeeded);
+	for (int tI = 0; tI < Batch.Num(); tI++)
+	{
+		if (Batch[tI]->RespawnTime > 0) continue;
+		Batch[tI]->AttachToComponent(tFree[tSlot++], FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+		Pickups.Add(Batch[tI]);
+		Inventory.Add(FInventoryTree::RootId, Batch[tI], Batch[tI]->Weight, Batch[tI]->IsContainer);
+	}
+	for (int tI = 0; tI < Batch.Num(); tI++)
+	{
+		Batch[tI]->DispatchPickedup(this); //Signal object who picked up
+		Batch[tI]->FinishPickup();
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("PickupBatch() took %d items, %d attach points left"), Batch.Num(), tFree.Num() - tSlotsNeeded);
+	if (GEngine != nullptr) GEngine->AddOnScreenDebugMessage(-1, 1.5, FColor::White, FString::Printf(TEXT("Picked up %d items"), Batch.Num()));
+	NotifyInventoryChanged(Batch);
+	return	true;
+}
+
+int AUnrealFPInventoryCharacter::PickupInRadius(float Radius)
+{
+	UWorld* const World = GetWorld();
+	if (World == nullptr) return 0;
+
+	TArray<FOverlapResult> tOverlaps;
+	FCollisionQueryParams tParams(SCENE_QUERY_STAT(PickupInRadius), false, this);
+	World->OverlapMultiByObjectType(tOverlaps, GetActorLocation(), FQuat::Identity, FCollisionObjectQueryParams(FCollisionObjectQueryParams::InitType::AllObjects), FCollisionShape::MakeSphere(Radius), tParams);
+
+	TSet<APickupActor*> tFound; //A pickup can overlap with more than one component
+	for (int tI = 0; tI < tOverlaps.Num(); tI++)
+	{
+		APickupActor* tPickup = Cast<APickupActor>(tOverlaps[tI].GetActor());
+		if (tPickup != nullptr && !tPickup->IsPickedUp) tFound.Add(tPickup);
+	}
+	const TArray<APickupActor*> tBatch = tFound.Array();
+
+	return PickupBatch(tBatch) ? tBatch.Num() : 0;
+}
+
+
+bool AUnrealFPInventoryCharacter::MoveToContainer(APickupActor* Item, APickupActor* Container)
+{
+	const int32 tId = Inventory.Find(Item);
+	const int32 tContainerId = Container != nullptr ? Inventory.Find(Container) : FInventoryTree::RootId;
+	if (tId == INDEX_NONE || tContainerId == INDEX_NONE) return false; //Both have to be ours
+	if (Inventory.GetParent(tId) == tContainerId) return true;
+
+	if (tContainerId == FInventoryTree::RootId) //Back on the character, needs somewhere to hang
+	{
+		TArray<UActorPickupLocation*> tFree;
+		GetFreePickupLocations(tFree);
+		if (tFree.Num() == 0 || !Inventory.Move(tId, tContainerId)) return false;
+		Item->AttachToComponent(tFree[0], FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+		Item->OnPlayerDepiction->SetHiddenInGame(false, true);
+		return	true;
+	}
+
+	if (!Inventory.Move(tId, tContainerId)) return false; //Not a container, or would end up inside itself
+	Item->AttachToActor(Container, FAttachmentTransformRules::SnapToTargetNotIncludingScale); //Frees its attach point, travels with the bag
+	Item->OnPlayerDepiction->SetHiddenInGame(true, true);
+	return	true;
+}
+
+APickupActor* AUnrealFPInventoryCharacter::GetContainer(APickupActor* Item)
+{
+	return Inventory.GetItem(Inventory.GetParent(Inventory.Find(Item))); //Root has no item so that comes back nullptr
+}
+
+float AUnrealFPInventoryCharacter::InventoryWeight(APickupActor* Container)
+{
+	return Inventory.GetWeight(Container != nullptr ? Inventory.Find(Container) : FInventoryTree::RootId);
+}
+
+int AUnrealFPInventoryCharacter::InventoryCount(APickupActor* Container)
+{
+	return Inventory.GetCount(Container != nullptr ? Inventory.Find(Container) : FInventoryTree::RootId);
+}
+
+void AUnrealFPInventoryCharacter::RemoveFromInventory(APickupActor* Item)
+{
+	TArray<APickupActor*> tInside;
+	const int32 tId = Inventory.Find(Item);
+	if (tId != INDEX_NONE)
+	{
+		Inventory.GetItemsInside(tId, tInside);
+		if (tInside.Num() > 0)
+		{
+			const TSet<APickupActor*> tInsideSet(tInside);
+			Pickups.RemoveAll([&tInsideSet](APickupActor* tPickup) { return tInsideSet.Contains(tPickup); });
+		}
+		Inventory.Remove(tId);
+	}
+	Pickups.Remove(Item);
+
+	const FVector tDropLocation = Item != nullptr ? Item->GetActorLocation() : GetActorLocation(); //Where the bag is now, before it is put back
+	for (int tI = 0; tI < tInside.Num(); tI++) //Contents don't leave with the bag, they fall out where it was
+	{
+		tInside[tI]->Drop(tDropLocation);
+	}
+}
 
 int AUnrealFPInventoryCharacter::ItemCount()
 {
@@ -7,6 +7,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "InventoryTree.h"
 #include "UnrealFPInventoryCharacter.generated.h"
 
 class APickupActor; //Forward Reference
@@ -70,11 +71,23 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
 	class UAnimMontage* FireAnimation;
 
+private:
+	/** Projectiles we have fired, reused once they land rather than spawning and destroying one per shot */
+	UPROPERTY()
+	TArray<class AUnrealFPInventoryProjectile*> ProjectilePool;
+
 protected:
 	
 	/** Fires a projectile. */
 	void OnFire();
 
+	/** Clients fire through this, FireTime is the server time the client was seeing when it pulled the trigger */
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerFire(FVector_NetQuantize Location, FRotator Rotation, float FireTime);
+
+	/** Spawns a projectile, or reuses one from the pool, on the server */
+	void FireProjectile(const FVector& Location, const FRotator& Rotation, float FireTime);
+
 	/** Handles moving forward/backward */
 	void MoveForward(float Val);
 
@@ -117,6 +130,35 @@ public:
 	bool OnPickup(APickupActor* Pickup); //Can override this in BP
 	bool OnPickup_Implementation(APickupActor* Pickup); //C++ Parent
 
+	bool TryPickup(APickupActor* Pickup); //Call this from C++, asks OnPickup (only through the script VM if BP overrides it) then finishes the pickup and notifies
+
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable)
+	bool CanPickupBatch(const TArray<APickupActor*>& Batch); //Veto for PickupBatch(), override in BP alongside OnPickup so batches follow the same rules, batches are allowed (with a warning) if only OnPickup is overridden
+	bool CanPickupBatch_Implementation(const TArray<APickupActor*>& Batch); //C++ Parent, accepts everything
+
+	UFUNCTION(BlueprintCallable)
+	bool PickupBatch(const TArray<APickupActor*>& Batch); //All or nothing, fails without changing anything if there isn't room for every item
+
+	UFUNCTION(BlueprintCallable)
+	int PickupInRadius(float Radius); //Vacuum up every pickup within Radius as one batch, returns how many were taken
+
+	UFUNCTION(BlueprintImplementableEvent, Category = Gameplay)
+	void OnInventoryChanged(const TArray<APickupActor*>& Added); //One notification per pickup or batch, only items still held once picked up, implemented in BP
+
+	UFUNCTION(BlueprintCallable)
+	bool MoveToContainer(APickupActor* Item, APickupActor* Container); //nullptr Container puts it back on the character, which needs a free attach point
+
+	UFUNCTION(BlueprintCallable, BlueprintPure)
+	APickupActor* GetContainer(APickupActor* Item); //What Item is in, nullptr if carried directly or not held
+
+	UFUNCTION(BlueprintCallable, BlueprintPure)
+	float InventoryWeight(APickupActor* Container); //Container and everything in it, nullptr for the whole inventory
+
+	UFUNCTION(BlueprintCallable, BlueprintPure)
+	int InventoryCount(APickupActor* Container); //Items inside at every level, nullptr for the whole inventory
+
+	void RemoveFromInventory(APickupActor* Item); //Takes Item out of the inventory, anything inside it is dropped where Item is
+
 	UFUNCTION(BlueprintCallable,BlueprintPure)
 	int ItemCount();
 
@@ -132,5 +174,17 @@ public:
 	UPROPERTY(BlueprintGetter = AmmoGetter, Category = Gameplay)
 	int	Ammo;
 
+private:
+
+	bool	ScriptOnPickup; //Whether this class overrides OnPickup in BP, cached in BeginPlay()
+
+	bool	ScriptCanPickupBatch; //Same for CanPickupBatch
+
+	void	NotifyInventoryChanged(const TArray<APickupActor*>& Added); //OnInventoryChanged with the items that are actually held, skipped if none are
+
+	FInventoryTree Inventory; //Who holds what, Pickups stays the flat list of everything carried
+
+	void	GetFreePickupLocations(TArray<class UActorPickupLocation*>& OutLocations); //Attach points with nothing on them
+
 };
 
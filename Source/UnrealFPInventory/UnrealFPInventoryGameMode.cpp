@@ -4,6 +4,19 @@
 #include "UnrealFPInventoryHUD.h"
 #include "UnrealFPInventoryCharacter.h"
 #include "UObject/ConstructorHelpers.h"
+#include "Components/CapsuleComponent.h"
+
+static TAutoConsoleVariable<float> CVarLagCompensationTolerance(
+	TEXT("fp.LagCompensation.Tolerance"),
+	10.0f,
+	TEXT("Extra radius in cm allowed when validating a hit against rewound capsules, covers interpolation error."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarLagCompensationMaxRewind(
+	TEXT("fp.LagCompensation.MaxRewind"),
+	0.25f,
+	TEXT("Furthest back in seconds a client's fire time is trusted, older claims are clamped to this so a client can't pick from the whole history."),
+	ECVF_Default);
 
 AUnrealFPInventoryGameMode::AUnrealFPInventoryGameMode()
 	: Super()
@@ -14,4 +27,54 @@ AUnrealFPInventoryGameMode::AUnrealFPInventoryGameMode()
 
 	// use our custom HUD class
 	HUDClass = AUnrealFPInventoryHUD::StaticClass();
+
+	// record character history once they have moved this frame
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+}
+
+void AUnrealFPInventoryGameMode::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	CharacterHistory.BeginFrame(GetWorld()->GetTimeSeconds());
+	for (int tSlot = 0; tSlot < HistoryCharacters.Num(); tSlot++)
+	{
+		AUnrealFPInventoryCharacter* tCharacter = HistoryCharacters[tSlot];
+		if (tCharacter == nullptr) continue;
+		const UCapsuleComponent* tCapsule = tCharacter->GetCapsuleComponent();
+		CharacterHistory.SetCapsule(tSlot, tCapsule->GetScaledCapsuleRadius(), tCapsule->GetScaledCapsuleHalfHeight()); //Can change when crouching
+		CharacterHistory.Record(tSlot, tCapsule->GetComponentLocation());
+	}
+}
+
+void AUnrealFPInventoryGameMode::RegisterHistory(AUnrealFPInventoryCharacter* Character)
+{
+	if (Character == nullptr || HistoryCharacters.Contains(Character)) return;
+
+	const int32 tSlot = CharacterHistory.AddCharacter(GetWorld()->GetTimeSeconds());
+	if (tSlot >= HistoryCharacters.Num()) HistoryCharacters.SetNumZeroed(tSlot + 1);
+	HistoryCharacters[tSlot] = Character;
+}
+
+void AUnrealFPInventoryGameMode::UnregisterHistory(AUnrealFPInventoryCharacter* Character)
+{
+	const int32 tSlot = HistoryCharacters.Find(Character);
+	if (Character == nullptr || tSlot == INDEX_NONE) return;
+
+	CharacterHistory.RemoveCharacter(tSlot);
+	HistoryCharacters[tSlot] = nullptr;
+}
+
+AUnrealFPInventoryCharacter* AUnrealFPInventoryGameMode::RewindShot(AActor* Shooter, float FireTime, const FVector& Start, const FVector& End, float ShotRadius)
+{
+	const int32 tIgnore = Shooter != nullptr ? HistoryCharacters.Find(Cast<AUnrealFPInventoryCharacter>(Shooter)) : INDEX_NONE; //Can't shoot yourself
+	const int32 tSlot = CharacterHistory.Rewind(FireTime, Start, End, ShotRadius + CVarLagCompensationTolerance.GetValueOnGameThread(), tIgnore);
+	return tSlot != INDEX_NONE ? HistoryCharacters[tSlot] : nullptr;
+}
+
+float AUnrealFPInventoryGameMode::ClampFireTime(float FireTime) const
+{
+	const float tNow = GetWorld()->GetTimeSeconds();
+	return FMath::Clamp(FireTime, tNow - FMath::Max(CVarLagCompensationMaxRewind.GetValueOnGameThread(), 0.f), tNow);
 }
@@ -4,8 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
+#include "CharacterHistory.h"
 #include "UnrealFPInventoryGameMode.generated.h"
 
+class AUnrealFPInventoryCharacter; //Forward Reference
+
 UCLASS(minimalapi)
 class AUnrealFPInventoryGameMode : public AGameModeBase
 {
@@ -13,6 +16,28 @@ class AUnrealFPInventoryGameMode : public AGameModeBase
 
 public:
 	AUnrealFPInventoryGameMode();
+
+	/** Records character positions for lag compensation, after movement has run */
+	virtual void Tick(float DeltaSeconds) override;
+
+//Lag compensation, game mode only exists on the server so this is server only
+public:
+
+	void	RegisterHistory(AUnrealFPInventoryCharacter* Character); //Called from character BeginPlay()
+	void	UnregisterHistory(AUnrealFPInventoryCharacter* Character); //Called from character EndPlay()
+
+	/** A client's claimed fire time, kept within fp.LagCompensation.MaxRewind of now and never in the future */
+	float	ClampFireTime(float FireTime) const;
+
+	/** Check a shot against where characters were at FireTime, returns the character hit first or nullptr */
+	AUnrealFPInventoryCharacter* RewindShot(AActor* Shooter, float FireTime, const FVector& Start, const FVector& End, float ShotRadius);
+
+private:
+
+	FCharacterHistory CharacterHistory;
+
+	UPROPERTY()
+	TArray<AUnrealFPInventoryCharacter*> HistoryCharacters; //Indexed by history slot, nullptr when free
 };
 
 
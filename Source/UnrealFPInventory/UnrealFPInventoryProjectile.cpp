@@ -3,6 +3,10 @@
 #include "UnrealFPInventoryProjectile.h"
 #include "GameFramework/ProjectileMovementComponent.h"
 #include "Components/SphereComponent.h"
+#include "UnrealFPInventoryCharacter.h"
+#include "UnrealFPInventoryGameMode.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
 
 AUnrealFPInventoryProjectile::AUnrealFPInventoryProjectile() 
 {
@@ -11,6 +15,7 @@ AUnrealFPInventoryProjectile::AUnrealFPInventoryProjectile()
 	CollisionComp->InitSphereRadius(5.0f);
 	CollisionComp->BodyInstance.SetCollisionProfileName("Projectile");
 	CollisionComp->OnComponentHit.AddDynamic(this, &AUnrealFPInventoryProjectile::OnHit);		// set up a notification for when this component hits something blocking
+	CollisionComp->BodyInstance.SetResponseToChannel(ECC_Pawn, ECR_Ignore);		// characters are hit where the shooter saw them, see CheckRewoundHit(), not where they are now
 
 	// Players can't walk on it
 	CollisionComp->SetWalkableSlopeOverride(FWalkableSlopeOverride(WalkableSlope_Unwalkable, 0.f));
@@ -29,6 +34,104 @@ AUnrealFPInventoryProjectile::AUnrealFPInventoryProjectile()
 
 	// Die after 3 seconds by default
 	InitialLifeSpan = 3.0f;
+
+	// only the server spawns these, clients see the replicated one
+	bReplicates = true;
+	bReplicateMovement = true;
+
+	FireTimestamp = 0.f;
+	SpawnTimestamp = 0.f;
+	bPooled = false;
+	bInFlight = true;
+
+	// the server checks each move against rewound characters once movement has run
+	PrimaryActorTick.bCanEverTick = true;
+}
+
+void AUnrealFPInventoryProjectile::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// no latency unless whoever spawned us says otherwise
+	SpawnTimestamp = GetWorld()->GetTimeSeconds();
+	if (FireTimestamp <= 0.f) FireTimestamp = SpawnTimestamp;
+
+	LastCheckedLocation = GetActorLocation();
+	AddTickPrerequisiteComponent(ProjectileMovement);
+	SetActorTickEnabled(HasAuthority());
+}
+
+void AUnrealFPInventoryProjectile::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (CheckRewoundHit()) Release();
+}
+
+bool AUnrealFPInventoryProjectile::CheckRewoundHit()
+{
+	const FVector Start = LastCheckedLocation;
+	LastCheckedLocation = GetActorLocation();
+	if (!HasAuthority() || !bInFlight || Start.Equals(LastCheckedLocation)) return false;
+
+	AUnrealFPInventoryGameMode* GameMode = GetWorld()->GetAuthGameMode<AUnrealFPInventoryGameMode>();
+	if (GameMode == NULL) return false;
+
+	// characters as they were when the shooter saw this part of the flight, shifted back by their latency
+	const float RewindTime = GetWorld()->GetTimeSeconds() - (SpawnTimestamp - FireTimestamp);
+	AUnrealFPInventoryCharacter* Victim = GameMode->RewindShot(Instigator, RewindTime, Start, LastCheckedLocation, CollisionComp->GetScaledSphereRadius());
+	if (Victim == NULL) return false;
+
+	OnValidatedHit(Victim);
+	return true;
+}
+
+void AUnrealFPInventoryProjectile::SetPooled()
+{
+	bPooled = true;
+	SetLifeSpan(0.f); // never destroyed, Release() parks us instead
+	GetWorldTimerManager().SetTimer(LifeSpanTimer, this, &AUnrealFPInventoryProjectile::Release, InitialLifeSpan, false);
+}
+
+void AUnrealFPInventoryProjectile::Launch(const FVector& Location, const FRotator& Rotation, float FireTime)
+{
+	bInFlight = true;
+	SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+
+	// movement drops its updated component when it comes to rest, so hook it back up
+	ProjectileMovement->SetUpdatedComponent(CollisionComp);
+	ProjectileMovement->Velocity = Rotation.Vector() * ProjectileMovement->InitialSpeed;
+	ProjectileMovement->SetComponentTickEnabled(true);
+
+	SpawnTimestamp = GetWorld()->GetTimeSeconds();
+	FireTimestamp = FireTime;
+	LastCheckedLocation = Location;
+	SetActorTickEnabled(true);
+	GetWorldTimerManager().SetTimer(LifeSpanTimer, this, &AUnrealFPInventoryProjectile::Release, InitialLifeSpan, false);
+}
+
+void AUnrealFPInventoryProjectile::Release()
+{
+	if (!HasAuthority()) return; // clients follow the server's copy
+
+	CheckRewoundHit(); // the stretch since the last tick, up to wherever we stopped
+
+	if (!bPooled)
+	{
+		Destroy();
+		return;
+	}
+
+	// park out of the way until the pool hands us out again
+	bInFlight = false;
+	SetActorTickEnabled(false);
+	GetWorldTimerManager().ClearTimer(LifeSpanTimer);
+	ProjectileMovement->StopMovementImmediately();
+	ProjectileMovement->SetComponentTickEnabled(false);
+	SetActorEnableCollision(false);
+	SetActorHiddenInGame(true);
 }
 
 void AUnrealFPInventoryProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
@@ -38,6 +141,6 @@ void AUnrealFPInventoryProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* O
 	{
 		OtherComp->AddImpulseAtLocation(GetVelocity() * 100.0f, GetActorLocation());
 
-		Destroy();
+		Release();
 	}
 }
\ No newline at end of file
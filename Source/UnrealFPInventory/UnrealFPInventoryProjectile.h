@@ -22,10 +22,53 @@ class AUnrealFPInventoryProjectile : public AActor
 public:
 	AUnrealFPInventoryProjectile();
 
+	virtual void BeginPlay() override;
+
+	/** Server only, runs after movement to check the move against rewound characters */
+	virtual void Tick(float DeltaSeconds) override;
+
 	/** called when projectile hits something */
 	UFUNCTION()
 	void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
 
+	/** called on the server when the projectile hits a character where the shooter saw them, the projectile is released straight after */
+	UFUNCTION(BlueprintImplementableEvent, Category = Projectile)
+	void OnValidatedHit(class AUnrealFPInventoryCharacter* Victim);
+
+	/** Server time the shooter fired at, as seen by the shooter. Defaults to spawn time, ServerFire sets the client's value before spawning */
+	UPROPERTY(BlueprintReadWrite, Category = Projectile)
+	float FireTimestamp;
+
+	/** Owner keeps this in a pool, so Release() parks it rather than destroying it and InitialLifeSpan is handled by a timer */
+	void SetPooled();
+
+	/** Put a parked projectile back in flight, as if it had just been spawned there with FireTimestamp set to FireTime */
+	void Launch(const FVector& Location, const FRotator& Rotation, float FireTime);
+
+	/** Done with this projectile, parked if pooled otherwise destroyed */
+	void Release();
+
+	/** False while parked in a pool */
+	FORCEINLINE bool IsInFlight() const { return bInFlight; }
+
+private:
+	/** Server time we were spawned, FireTimestamp is behind this by the shooter's latency */
+	float SpawnTimestamp;
+
+	uint8 bPooled : 1;
+	uint8 bInFlight : 1;
+
+	/** Stands in for InitialLifeSpan once pooled */
+	FTimerHandle LifeSpanTimer;
+
+	/** Where the last rewound check stopped, the next one covers from here to where we are now */
+	FVector LastCheckedLocation;
+
+	/** Test the move since the last check against characters rewound by the shooter's latency, fires OnValidatedHit and returns true on a hit */
+	bool CheckRewoundHit();
+
+public:
+
 	/** Returns CollisionComp subobject **/
 	FORCEINLINE class USphereComponent* GetCollisionComp() const { return CollisionComp; }
 	/** Returns ProjectileMovement subobject **/